@@ -32,7 +32,8 @@ GLuint program::compile(GLenum type, const std::filesystem::path& path)
     }
 
     GLuint shader = GL_SAFE_EX(tao::tuple(0), glCreateShader, type);
-    GL_SAFE(glShaderSource, shader, 1, (const char **)&file_mapping->addr, &file_mapping->length);
+    GLint length = static_cast<GLint>(file_mapping->length);
+    GL_SAFE(glShaderSource, shader, 1, (const char **)&file_mapping->addr, &length);
     GL_SAFE(glCompileShader, shader);
     
     unmap_file(*file_mapping);
@@ -43,9 +44,9 @@ GLuint program::compile(GLenum type, const std::filesystem::path& path)
     if (result == GL_FALSE)
     {
         /* get the shader info log */
-        GL_SAFE(glGetShaderiv, shader, GL_INFO_LOG_LENGTH, &file_mapping->length);
-        char* log = new char[file_mapping->length];
-        GL_SAFE(glGetShaderInfoLog, shader, file_mapping->length, &result, log);
+        GL_SAFE(glGetShaderiv, shader, GL_INFO_LOG_LENGTH, &length);
+        char* log = new char[length];
+        GL_SAFE(glGetShaderInfoLog, shader, length, &result, log);
 
         /* print an error message and the info log */
         //LOGD("Unable to compile %s: %s", path.c_str(), log);
@@ -0,0 +1,163 @@
+// Radius and k-nearest queries over the hex grid against a brute force scan
+//  Usage: umi_spatial_bench [entities=10000,100000] [queries=10000] [radius=50] [k=8]
+
+#include "maps/hex_grid.hpp"
+#include "maps/offset.hpp"
+#include "maps/spatial_query.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+// Same layout map cells use for queries
+struct bench_cell
+{
+    using offset_t = offset<float, 15>;
+
+    bench_cell(const offset_t&)
+    {}
+
+    inline const std::vector<glm::vec2>& positions() const
+    {
+        return _positions;
+    }
+
+    std::vector<glm::vec2> _positions;
+};
+
+template <typename F>
+double measure(F&& function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void run(long num_entities, long num_queries, float radius, uint32_t k)
+{
+    // Keep density constant, about 4 entities per cell
+    const float side = std::sqrt(static_cast<float>(num_entities) / 4.0f) * 15.0f * 1.7f;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-side / 2, side / 2);
+
+    std::vector<glm::vec2> positions;
+    hex_grid<bench_cell, bench_cell::offset_t, 16> grid;
+    for (long i = 0; i < num_entities; ++i)
+    {
+        const glm::vec2 position { distribution(generator), distribution(generator) };
+        positions.push_back(position);
+
+        const auto offset = bench_cell::offset_t::of(position.x, position.y);
+        grid.get_or_emplace(offset, offset).first->_positions.push_back(position);
+    }
+
+    std::vector<glm::vec2> centers;
+    for (long i = 0; i < num_queries; ++i)
+    {
+        centers.push_back({ distribution(generator), distribution(generator) });
+    }
+
+    auto distance_sq = [](const glm::vec2& lhs, const glm::vec2& rhs) {
+        const glm::vec2 delta = lhs - rhs;
+        return delta.x * delta.x + delta.y * delta.y;
+    };
+
+    // Radius
+    uint64_t grid_found = 0;
+    uint64_t brute_found = 0;
+
+    const double grid_radius = measure([&]() {
+        for (const auto& center : centers)
+        {
+            spatial::query_radius(grid, center, radius, [&grid_found](bench_cell*, uint32_t) {
+                ++grid_found;
+            });
+        }
+    });
+
+    const double brute_radius = measure([&]() {
+        for (const auto& center : centers)
+        {
+            for (const auto& position : positions)
+            {
+                brute_found += distance_sq(position, center) <= radius * radius;
+            }
+        }
+    });
+
+    // K-nearest, bounded to the same radius
+    std::vector<spatial::hit<bench_cell>> hits;
+    std::vector<float> distances;
+    double grid_sum = 0;
+    double brute_sum = 0;
+
+    const double grid_nearest = measure([&]() {
+        for (const auto& center : centers)
+        {
+            spatial::nearest(grid, center, k, radius, hits);
+            for (const auto& hit : hits)
+            {
+                grid_sum += hit.distance_sq;
+            }
+        }
+    });
+
+    const double brute_nearest = measure([&]() {
+        for (const auto& center : centers)
+        {
+            distances.clear();
+            for (const auto& position : positions)
+            {
+                if (const float d = distance_sq(position, center); d <= radius * radius)
+                {
+                    distances.push_back(d);
+                }
+            }
+
+            const auto count = std::min<std::size_t>(k, distances.size());
+            std::partial_sort(distances.begin(), distances.begin() + count, distances.end());
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                brute_sum += distances[i];
+            }
+        }
+    });
+
+    std::cout << "Entities: " << num_entities << " in " << grid.size() << " cells, " << num_queries << " queries" << std::endl;
+    std::cout << "  radius " << radius << ":  grid " << grid_radius << "ms, brute " << brute_radius << "ms"
+        << (grid_found == brute_found ? "" : "  MISMATCH") << std::endl;
+    std::cout << "  nearest " << k << ":  grid " << grid_nearest << "ms, brute " << brute_nearest << "ms"
+        << (std::abs(grid_sum - brute_sum) <= 1e-3 * brute_sum ? "" : "  MISMATCH") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto arg = [argc, argv](int index, long fallback) {
+        return argc > index ? std::strtol(argv[index], nullptr, 10) : fallback;
+    };
+
+    const long num_queries = arg(2, 10000);
+    const float radius = static_cast<float>(arg(3, 50));
+    const uint32_t k = static_cast<uint32_t>(arg(4, 8));
+
+    if (argc > 1)
+    {
+        run(arg(1, 10000), num_queries, radius, k);
+    }
+    else
+    {
+        run(10000, num_queries, radius, k);
+        run(100000, num_queries, radius, k);
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Loopback UDP load generator, used to compare the server's network modes
+//  Usage: umi_udp_loadgen [clients=256] [rate_hz=30] [seconds=10] [port=7575] [size=64]
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+
+int main(int argc, char** argv)
+{
+    auto arg = [argc, argv](int index, long fallback) {
+        return argc > index ? std::strtol(argv[index], nullptr, 10) : fallback;
+    };
+
+    const long num_clients = arg(1, 256);
+    const long rate = arg(2, 30);
+    const long seconds = arg(3, 10);
+    const uint16_t port = static_cast<uint16_t>(arg(4, 7575));
+    const long size = arg(5, 64);
+
+    sockaddr_in server_address {};
+    server_address.sin_family = AF_INET;
+    server_address.sin_port = htons(port);
+    server_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // One socket per simulated client, so that the server sees distinct endpoints
+    std::vector<int> sockets;
+    for (long i = 0; i < num_clients; ++i)
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0)
+        {
+            std::cerr << "Could not open socket " << i << std::endl;
+            return 1;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        connect(fd, reinterpret_cast<sockaddr*>(&server_address), sizeof(server_address));
+        sockets.push_back(fd);
+    }
+
+    std::vector<uint8_t> payload(size, 0);
+    uint8_t incoming[1500];
+    uint64_t sent = 0;
+    uint64_t received = 0;
+
+    const auto tick = std::chrono::nanoseconds(1'000'000'000 / std::max(rate, 1l));
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::seconds(seconds);
+    auto next = start;
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (int fd : sockets)
+        {
+            if (send(fd, payload.data(), payload.size(), 0) > 0)
+            {
+                ++sent;
+            }
+
+            while (recv(fd, incoming, sizeof(incoming), 0) > 0)
+            {
+                ++received;
+            }
+        }
+
+        next += tick;
+        std::this_thread::sleep_until(next);
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Clients:  " << num_clients << " @ " << rate << "Hz" << std::endl;
+    std::cout << "Sent:     " << sent << " (" << sent / elapsed << " pps)" << std::endl;
+    std::cout << "Received: " << received << " (" << received / elapsed << " pps)" << std::endl;
+
+    for (int fd : sockets)
+    {
+        close(fd);
+    }
+
+    return 0;
+}
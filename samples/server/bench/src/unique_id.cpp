@@ -0,0 +1,129 @@
+// Database id generation throughput, block reserved snowflake ids against reading the clock
+//  and a shared atomic for every id
+//  Usage: umi_id_bench [ids per thread=1000000] [threads=1,4,8]
+
+#include "database/snowflake_id.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+template <typename F>
+double measure(F&& function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename F>
+std::vector<std::vector<uint64_t>> generate(long num_ids, long num_threads, F&& next)
+{
+    std::vector<std::vector<uint64_t>> ids(num_threads);
+    std::vector<std::thread> threads;
+    for (long t = 0; t < num_threads; ++t)
+    {
+        ids[t].reserve(num_ids);
+        threads.emplace_back([&next, &ids, num_ids, t]() {
+            for (long i = 0; i < num_ids; ++i)
+            {
+                ids[t].push_back(next());
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return ids;
+}
+
+std::size_t collisions(const std::vector<std::vector<uint64_t>>& ids)
+{
+    std::unordered_set<uint64_t> unique;
+    std::size_t total = 0;
+    for (const auto& list : ids)
+    {
+        total += list.size();
+        unique.insert(list.begin(), list.end());
+    }
+
+    return total - unique.size();
+}
+
+void run(long num_ids, long num_threads)
+{
+    std::vector<std::vector<uint64_t>> ids;
+
+    // Clock read and atomic increment per id
+    std::atomic<uint64_t> counter = 0;
+    const double naive = measure([&]() {
+        ids = generate(num_ids, num_threads, [&counter]() {
+            const uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            return (now << 32) + counter.fetch_add(1, std::memory_order_relaxed);
+        });
+    });
+    const std::size_t naive_collisions = collisions(ids);
+
+    snowflake_id generator(1);
+    const double snowflake = measure([&]() {
+        ids = generate(num_ids, num_threads, [&generator]() {
+            thread_local snowflake_id::reservation block;
+            return generator.next(block);
+        });
+    });
+    const std::size_t snowflake_collisions = collisions(ids);
+
+    id_permutation permutation(0x5DEECE66D1B2C3A4);
+    uint64_t checksum = 0;
+    const double permuted = measure([&]() {
+        for (const auto& list : ids)
+        {
+            for (uint64_t id : list)
+            {
+                checksum += permutation.encode(id);
+            }
+        }
+    });
+
+    const double total = static_cast<double>(num_ids * num_threads);
+    std::cout << "Threads: " << num_threads << ", " << num_ids << " ids each" << std::endl;
+    std::cout << "  per id clock:  " << naive << "ms (" << total / naive / 1000.0 << " M/s), "
+        << naive_collisions << " collisions" << std::endl;
+    std::cout << "  snowflake:     " << snowflake << "ms (" << total / snowflake / 1000.0 << " M/s), "
+        << snowflake_collisions << " collisions" << std::endl;
+    std::cout << "  permutation:   " << permuted << "ms single threaded (" << total / permuted / 1000.0 << " M/s)"
+        << (checksum ? "" : "  EMPTY") << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto arg = [argc, argv](int index, long fallback) {
+        return argc > index ? std::strtol(argv[index], nullptr, 10) : fallback;
+    };
+
+    const long num_ids = arg(1, 1000000);
+
+    if (argc > 2)
+    {
+        run(num_ids, arg(2, 1));
+    }
+    else
+    {
+        run(num_ids, 1);
+        run(num_ids, 4);
+        run(num_ids, 8);
+    }
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 #include <inttypes.h>
 #include <chrono>
+#include <cstddef>
 
 
 using std_clock_t = std::chrono::steady_clock;
@@ -27,6 +28,23 @@ enum class database_collections : uint8_t
     characters =        1
 };
 
+// Most write operations sent in a single bulk write when coalescing transactions
+constexpr inline uint32_t MaxCoalescedWrites = 1000;
+
+// Must be unique for every server writing to the same database, see snowflake_id
+constexpr inline uint16_t DatabaseShard = 0;
+
+// Ids reserved at once by each thread generating database ids
+constexpr inline uint32_t IdReservationSize = 256;
+
+// Key of the permutation applied to database ids sent to clients, changing it changes
+//  every id clients have seen
+constexpr inline uint64_t PublicIdKey = 0x5DEECE66D1B2C3A4;
+
+// Bytes of documents and of cached query results kept in memory
+constexpr inline std::size_t DocumentCacheSize = 64 * 1024 * 1024;
+constexpr inline std::size_t QueryCacheSize = 4 * 1024 * 1024;
+
 
 
 
@@ -40,11 +58,33 @@ enum class FiberID
     DatabaseWorker =    2
 };
 
+// Upper bound of threads that might record into per-worker buffers
+constexpr inline uint16_t MaxWorkerThreads = 64;
+
+// Smallest amount of transforms updated as a single unit of work
+constexpr inline uint32_t MapUpdateMinGrain = 64;
+
+
 
 
 
 
 
+// NETWORKING
+constexpr inline uint16_t MaxDatagramSize = 500;
+
+// Datagrams per recvmmsg/sendmmsg call in batched mode
+constexpr inline uint16_t NetworkBatchSize = 64;
+
+enum class network_mode : uint8_t
+{
+    asio        = 0,    // One asynchronous operation per datagram
+    batched     = 1     // recvmmsg/sendmmsg, only available on Linux
+};
+
+
+
+
 
 // COMMON STRUCTURES
 struct udp_buffer
@@ -21,6 +21,7 @@ void client::construct(const udp::endpoint& endpoint)
     _ingame_status = ingame_status::new_connection;
     _database_information = std::nullopt;
     _ingame_entity = nullptr;
+    _inbox = std::make_shared<client_inbox>();
 
     reset();
 }
@@ -39,6 +40,11 @@ void client::update(update_inputs_t, const base_time& diff)
         return;
     }
 
+    // Packets routed directly from network threads
+    _inbox->drain([this](auto&& packet) {
+        received_packet(std::move(packet));
+    });
+
     // Read inputs
     _protocol.read<kumo::marshal, base_time>(this, super_packet());
 }
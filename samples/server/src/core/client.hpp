@@ -10,6 +10,10 @@
 
 #include <boost/asio.hpp>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 
 template <typename T>
 class test_allocator : public std::allocator<T>
@@ -32,6 +36,22 @@ inline constexpr update_outputs_t update_outputs{};
 
 class transform;
 
+// Packets received on network threads for an already known client, drained on its
+//  input update. Lives outside the client so that it can be reached without touching it
+class client_inbox
+{
+public:
+    inline void push(boost::intrusive_ptr<::kaminari::data_wrapper>&& packet);
+
+    template <typename C>
+    void drain(C&& callback);
+
+private:
+    std::mutex _mutex;
+    std::vector<boost::intrusive_ptr<::kaminari::data_wrapper>> _packets;
+    std::vector<boost::intrusive_ptr<::kaminari::data_wrapper>> _draining;
+};
+
 class client : public entity<client>,
     public kaminari::client<
         kumo::protocol_queues<
@@ -57,6 +77,7 @@ public:
     inline ingame_status ingame_status() const;
     inline const std::optional<database_data>& database_information() const;
     inline transform* ingame_entity() const;
+    inline const std::shared_ptr<client_inbox>& inbox() const;
 
     inline void database_information(database_data&& data);
     inline void ingame_entity(transform* entity);
@@ -71,9 +92,34 @@ private:
     enum ingame_status _ingame_status;
     std::optional<database_data> _database_information;
     transform* _ingame_entity;
+    std::shared_ptr<client_inbox> _inbox;
 };
 
 
+inline void client_inbox::push(boost::intrusive_ptr<::kaminari::data_wrapper>&& packet)
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _packets.push_back(std::move(packet));
+}
+
+template <typename C>
+void client_inbox::drain(C&& callback)
+{
+    // Swap under the lock, so that network threads are not blocked by the callbacks
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _packets.swap(_draining);
+    }
+
+    for (auto& packet : _draining)
+    {
+        callback(std::move(packet));
+    }
+
+    _draining.clear();
+}
+
+
 inline const udp::endpoint& client::endpoint() const
 {
     return _endpoint;
@@ -94,6 +140,11 @@ inline transform* client::ingame_entity() const
     return _ingame_entity;
 }
 
+inline const std::shared_ptr<client_inbox>& client::inbox() const
+{
+    return _inbox;
+}
+
 inline void client::database_information(database_data&& data)
 {
     _database_information.emplace(std::move(data));
@@ -7,6 +7,9 @@
 #include <kumo/config.hpp>
 #include <kumo/rpc.hpp>
 
+#include <optional>
+#include <vector>
+
 
 using bsoncxx::builder::basic::make_document;
 using bsoncxx::builder::basic::make_array;
@@ -78,11 +81,7 @@ bool handler::on_login(::kaminari::basic_client* kaminari_client, const ::kumo::
             auto result = collection.find_one_and_update(filter.view(), update.view());
             if (!result)
             {
-                server::instance->schedule_if(ticket, [](class client* client)
-                    {
-                        kumo::send_login_response(client->super_packet(), { .code = 1 });
-                        client->handshake_done();
-                    });
+                server::instance->login_results().push(std::move(ticket), login_result { .code = 1 });
             }
             else
             {
@@ -90,11 +89,7 @@ bool handler::on_login(::kaminari::basic_client* kaminari_client, const ::kumo::
                 auto user = result->view();
                 if (user["logged"].get_bool().value)
                 {
-                    server::instance->schedule_if(ticket, [](class client* client)
-                        {
-                            kumo::send_login_response(client->super_packet(), { .code = 2 });
-                            client->handshake_done();
-                        });
+                    server::instance->login_results().push(std::move(ticket), login_result { .code = 2 });
                     return;
                 }
 
@@ -103,12 +98,31 @@ bool handler::on_login(::kaminari::basic_client* kaminari_client, const ::kumo::
                 });
                 client->login_done();
 
-                auto characters_collection = database::instance->get_collection(static_cast<uint8_t>(database_collections::characters));
-                std::vector<kumo::character> characters;
+                // Characters are read again on selection, keep them around
+                constexpr uint8_t characters_collection = static_cast<uint8_t>(database_collections::characters);
+                auto cache = database::instance->cache();
+                auto documents = cache->find_list(characters_collection, data.username);
+                if (!documents)
+                {
+                    auto read = cache->begin_read();
+                    auto collection = database::instance->get_collection(characters_collection);
+                    auto cursor = collection.find(make_document(kvp("username", data.username)));
+
+                    documents.emplace();
+                    std::vector<bsoncxx::document::view> views;
+                    for (auto character : cursor)
+                    {
+                        documents->emplace_back(character);
+                        views.push_back(documents->back().view());
+                    }
+
+                    cache->store_list(read, characters_collection, data.username, views);
+                }
 
-                auto cursor = characters_collection.find(make_document(kvp("username", data.username)));
-                for (auto character : cursor)
+                std::vector<kumo::character> characters;
+                for (auto& document : *documents)
                 {
+                    auto character = document.view();
                     characters.push_back(kumo::character {
                         .name = std::string(character["name"].get_utf8().value),
                         .level = static_cast<uint16_t>(character["level"].get_int32().value)
@@ -116,11 +130,7 @@ bool handler::on_login(::kaminari::basic_client* kaminari_client, const ::kumo::
                 }
 
                 // Send login response with characters
-                server::instance->schedule_if(ticket, [characters{ std::move(characters) }](class client* client) mutable
-                    {
-                        kumo::send_login_response(client->super_packet(), { .code = 0 });
-                        kumo::send_characters_list(client->super_packet(), { .list = std::move(characters) });
-                    });
+                server::instance->login_results().push(std::move(ticket), login_result { .code = 0, .characters = std::move(characters) });
             }
         });
 
@@ -139,51 +149,55 @@ bool handler::on_character_selected(::kaminari::basic_client* kaminari_client, c
         }
         auto client = ticket->get()->derived();
 
-        auto filter = make_document(
-            kvp("username", client->database_information()->username),
-            kvp("index", data.index)
-        );
+        constexpr uint8_t characters_collection = static_cast<uint8_t>(database_collections::characters);
+        auto cache = database::instance->cache();
+        auto& username = client->database_information()->username;
+
+        // Most of the time the list fetched on login is still cached
+        std::optional<bsoncxx::document::value> result;
+        if (auto documents = cache->find_list(characters_collection, username))
+        {
+            for (auto& document : *documents)
+            {
+                if (document.view()["index"].get_int32().value == data.index)
+                {
+                    result = std::move(document);
+                    break;
+                }
+            }
+        }
+        else
+        {
+            auto filter = make_document(
+                kvp("username", username),
+                kvp("index", data.index)
+            );
+
+            auto read = cache->begin_read();
+            auto collection = database::instance->get_collection(characters_collection);
+            if (auto document = collection.find_one(filter.view()))
+            {
+                cache->store(read, characters_collection, document->view());
+                result = std::move(*document);
+            }
+        }
 
-        auto collection = database::instance->get_collection(static_cast<uint8_t>(database_collections::characters));
-        auto result = collection.find_one(filter.view());
         if (!result)
         {
-            // Selected a non-existing character
-            server::instance->disconnect_client(client);
+            server::instance->character_results().push(std::move(ticket), character_result { .found = false });
             return;
         }
 
-        // Load map and create character
-        auto& character = result->view();
-        server::instance->get_or_create_map(static_cast<uint64_t>(character["position"]["map"].get_int64().value), [
-            ticket,
-            db_id = static_cast<uint64_t>(character["_id"].get_int64().value),
-            position = glm::vec3(
-                static_cast<float>(character["position"]["x"].get_double().value), 
+        auto character = result->view();
+        server::instance->character_results().push(std::move(ticket), character_result {
+            .found = true,
+            .map_id = static_cast<uint64_t>(character["position"]["map"].get_int64().value),
+            .db_id = static_cast<uint64_t>(character["_id"].get_int64().value),
+            .position = glm::vec3(
+                static_cast<float>(character["position"]["x"].get_double().value),
                 static_cast<float>(character["position"]["y"].get_double().value),
                 static_cast<float>(character["position"]["z"].get_double().value))
-        ](map* map) mutable
-            {
-                if (!ticket->valid())
-                {
-                    return;
-                }
-
-                auto client = ticket->get()->derived();
-
-                map->create_entity_at(client->id(), db_id, position, [ticket](auto map_aware, auto transform) mutable
-                    {
-                        if (!ticket->valid())
-                        {
-                            transform->current_region()->remove_entity(transform);
-                            return;
-                        }
-
-                        auto client = ticket->get()->derived();
-                        client->ingame_entity(transform);
-                        kumo::send_enter_world(client->super_packet(), {});
-                    });
-            });
+        });
     });
 
     return true;
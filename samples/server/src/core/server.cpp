@@ -1,9 +1,11 @@
 #include "core/server.hpp"
+#include "database/database.hpp"
 #include "entities/transform.hpp"
 
 #include <kaminari/types/data_wrapper.hpp>
 #include <kumo/rpc.hpp>
 
+#include <pools/frame_allocator.hpp>
 #include <pools/singleton_pool.hpp>
 #include <fiber/exclusive_shared_work.hpp>
 #include <fiber/yield.hpp>
@@ -16,9 +18,15 @@
     #pragma comment(lib, "Winmm.lib")
 #endif // _MSC_VER 
 
+#ifdef __linux__
+    #include <cerrno>
+    #include <poll.h>
+    #include <sys/socket.h>
+#endif
+
 
 
-server::server(uint16_t port, uint8_t num_server_workers, uint8_t num_network_workers) :
+server::server(uint16_t port, uint8_t num_server_workers, uint8_t num_network_workers, network_mode mode, bool reuse_port) :
     base_executor<server>(),
     _store(),
     _map_scheme(_store),
@@ -26,15 +34,36 @@ server::server(uint16_t port, uint8_t num_server_workers, uint8_t num_network_wo
     _transaction_scheme(_store),
     _last_tick(std_clock_t::now()),
     _diff_mean(static_cast<float>(HeartBeat.count())),
-    _context(num_network_workers),
-    _work(boost::asio::make_work_guard(_context)),
-    _socket(_context, udp::endpoint(udp::v4(), port)),
+    _network_threads(),
+    _shards(),
+    _network_mode(mode),
+    _outgoing(),
+    _outgoing_queues(0),
     _database_async(2, 128),
+    _write_coalescer(MaxCoalescedWrites),
+    _login_results(),
+    _character_results(),
     _stop(false)
 {
     // Set instance
     instance = this;
 
+#ifndef __linux__
+    assert(_network_mode == network_mode::asio && "Batched networking is only available on Linux");
+    _network_mode = network_mode::asio;
+
+    assert(!reuse_port && "SO_REUSEPORT load balancing is only available on Linux");
+    reuse_port = false;
+#endif
+
+    // Kernel hashes by 4-tuple, a given client always lands on the same shard
+    uint8_t num_shards = reuse_port ? num_network_workers : 1;
+    uint8_t concurrency = reuse_port ? 1 : num_network_workers;
+    for (uint8_t i = 0; i < num_shards; ++i)
+    {
+        _shards.push_back(std::make_unique<network_shard>(concurrency, udp::endpoint(udp::v4(), port), reuse_port));
+    }
+
     // Spawn executor threads
     base_executor<server>::start(num_server_workers, false);
 
@@ -66,6 +95,9 @@ void server::mainloop()
         // Execute tasks (basically, new clients and data)
         base_executor<server>::execute_tasks();
 
+        // Database results, might create maps and entities through new tasks
+        deliver_database_results();
+
         // Execute client inputs
         base_executor<server>::update(client_updater, update_inputs, std::ref(diff));
 
@@ -74,13 +106,22 @@ void server::mainloop()
         base_executor<server>::sync(map_updater, std::ref(diff));
 
         // Execute transactions
-        base_executor<server>::update(transactions_updater, static_cast<uint64_t>(diff.count()), (transaction::store_t*)&_transaction_scheme.get<transaction>(), (async_executor_base*)&database_async());
+        base_executor<server>::update(transactions_updater, static_cast<uint64_t>(diff.count()), (transaction::store_t*)&_transaction_scheme.get<transaction>(), (async_executor_base*)&database_async(), &_write_coalescer);
+        _write_coalescer.flush(&database_async(), database::instance->backend());
+        base_executor<server>::sync(transactions_updater);
 
         // Execute map and transactions tasks
         base_executor<server>::execute_tasks();
 
         // Execute client outputs
         base_executor<server>::update(client_updater, update_outputs, std::ref(diff));
+        flush_client_outputs();
+
+        // Anything marked from now on belongs to the next tick
+        change_epoch::advance();
+
+        // Tick-transient memory is released at once, nothing allocated from it may survive the tick
+        frame_arena::reset_all();
 
         // Rebalance pools
         kaminari_data_pool.rebalance();
@@ -116,19 +157,23 @@ void server::stop()
     _stop = true;
     base_executor<server>::stop();
 
+    for (auto& shard : _shards)
+    {
+        shard->work.reset();
+        shard->context.stop();
+    }
+
     for (auto& t : _network_threads)
     {
         t.join();
     }
-
-    _work.reset();
 }
 
 client* server::get_client(const udp::endpoint& endpoint) const
 {
-    if (auto it = _clients.find(endpoint); it != _clients.end())
+    if (auto route = _clients.find(endpoint))
     {
-        if (auto client = it->second.get(); client->valid())
+        if (auto client = route->entity_ticket.get(); client->valid())
         {
             return client->get()->derived();
         }
@@ -175,6 +220,59 @@ void server::schedule_entity_transaction_removal(transaction* t)
         });
 }
 
+void server::deliver_database_results()
+{
+    _login_results.drain([](entity<client>* entity, login_result& result)
+        {
+            auto client = entity->derived();
+            kumo::send_login_response(client->super_packet(), { .code = result.code });
+
+            if (result.code == 0)
+            {
+                kumo::send_characters_list(client->super_packet(), { .list = std::move(result.characters) });
+            }
+            else
+            {
+                client->handshake_done();
+            }
+        });
+
+    _character_results.drain([this](entity<client>* entity, character_result& result)
+        {
+            auto client = entity->derived();
+            if (!result.found)
+            {
+                // Selected a non-existing character
+                disconnect_client(client);
+                return;
+            }
+
+            // Load map and create character
+            get_or_create_map(result.map_id, [ticket = client->ticket(), db_id = result.db_id, position = result.position](map* map) mutable
+                {
+                    if (!ticket->valid())
+                    {
+                        return;
+                    }
+
+                    auto client = ticket->get()->derived();
+
+                    map->create_entity_at(client->id(), db_id, position, [ticket](auto map_aware, auto transform) mutable
+                        {
+                            if (!ticket->valid())
+                            {
+                                transform->current_region()->remove_entity(transform);
+                                return;
+                            }
+
+                            auto client = ticket->get()->derived();
+                            client->ingame_entity(transform);
+                            kumo::send_enter_world(client->super_packet(), {});
+                        });
+                });
+        });
+}
+
 void server::disconnect_client(client* client)
 {
     client->flag_disconnecting();
@@ -201,6 +299,7 @@ void server::disconnect_client(client* client)
             //}
 
             _clients.erase(client->endpoint());
+            _clients.reclaim();
             _client_scheme.free(client);
         }
     });
@@ -208,9 +307,16 @@ void server::disconnect_client(client* client)
 
 void server::send_client_outputs(client* client)
 {
+    if (_network_mode == network_mode::batched)
+    {
+        // Super packets are not touched again until next tick's outputs
+        outgoing_queue().push_back({ .buffer = client->super_packet()->buffer(), .endpoint = client->endpoint() });
+        return;
+    }
+
     std::cout << "SEND " << client->super_packet()->buffer().size() << "b TO " << client->endpoint() << std::endl;
 
-    _socket.async_send_to(client->super_packet()->buffer(), client->endpoint(), [](const boost::system::error_code& error, std::size_t bytes) {
+    shard_for(client->endpoint()).socket.async_send_to(client->super_packet()->buffer(), client->endpoint(), [](const boost::system::error_code& error, std::size_t bytes) {
         if (error)
         {
             // TODO(gpascualg): Do something in case of error
@@ -218,6 +324,88 @@ void server::send_client_outputs(client* client)
     });
 }
 
+void server::flush_client_outputs()
+{
+#ifdef __linux__
+    if (_network_mode != network_mode::batched)
+    {
+        return;
+    }
+
+    std::array<mmsghdr, NetworkBatchSize> headers;
+    std::array<iovec, NetworkBatchSize> iovecs;
+    uint16_t pending = 0;
+    int native_handle = _shards.front()->socket.native_handle();
+
+    auto send_pending = [native_handle, &headers, &pending]() {
+        uint16_t sent = 0;
+        while (sent < pending)
+        {
+            int result = sendmmsg(native_handle, headers.data() + sent, pending - sent, 0);
+            if (result >= 0)
+            {
+                sent += static_cast<uint16_t>(result);
+            }
+            else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+            {
+                // Socket buffer is full, wait for it to drain a bit
+                pollfd fd { .fd = native_handle, .events = POLLOUT, .revents = 0 };
+                poll(&fd, 1, 1);
+            }
+            else
+            {
+                // Skip the offending datagram, UDP gives no guarantees anyway
+                ++sent;
+            }
+        }
+
+        pending = 0;
+    };
+
+    for (uint16_t i = 0, count = _outgoing_queues; i < count; ++i)
+    {
+        for (auto& datagram : _outgoing[i])
+        {
+            iovecs[pending] = { .iov_base = const_cast<void*>(datagram.buffer.data()), .iov_len = datagram.buffer.size() };
+            headers[pending] = {};
+            headers[pending].msg_hdr.msg_name = datagram.endpoint.data();
+            headers[pending].msg_hdr.msg_namelen = static_cast<socklen_t>(datagram.endpoint.size());
+            headers[pending].msg_hdr.msg_iov = &iovecs[pending];
+            headers[pending].msg_hdr.msg_iovlen = 1;
+
+            if (++pending == NetworkBatchSize)
+            {
+                send_pending();
+            }
+        }
+    }
+
+    send_pending();
+
+    for (uint16_t i = 0, count = _outgoing_queues; i < count; ++i)
+    {
+        _outgoing[i].clear();
+    }
+#endif
+}
+
+server::network_shard::network_shard(uint8_t concurrency, const udp::endpoint& endpoint, bool reuse_port) :
+    context(concurrency),
+    work(boost::asio::make_work_guard(context)),
+    socket(context)
+{
+    socket.open(endpoint.protocol());
+
+#ifdef __linux__
+    if (reuse_port)
+    {
+        socket.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+    }
+#endif
+
+    socket.bind(endpoint);
+}
+
 void server::spawn_network_threads(uint8_t count)
 {
     std::mutex m;
@@ -226,7 +414,9 @@ void server::spawn_network_threads(uint8_t count)
 
     for (int i = 0; i < count; ++i)
     {
-        _network_threads.push_back(std::thread([this, &waiting, &m, &cv] {
+        network_shard* shard = _shards[i % _shards.size()].get();
+
+        _network_threads.push_back(std::thread([this, shard, &waiting, &m, &cv] {
             // This is a sink for endpoints and data
             endpoints_pool.this_thread_sinks();
             kaminari_data_pool.this_thread_sinks();
@@ -236,54 +426,144 @@ void server::spawn_network_threads(uint8_t count)
             cv.notify_one();
             lk.unlock();
 
-            _context.run();
+            shard->context.run();
         }));
 
-        handle_connections();
+        if (_network_mode == network_mode::batched)
+        {
+            handle_connections_batched(shard);
+        }
+        else
+        {
+            handle_connections(shard);
+        }
     }
 
     std::unique_lock<std::mutex> lk(m);
     cv.wait(lk, [&] { return waiting == 0; });
 }
 
-void server::handle_connections()
+void server::handle_connections(network_shard* shard)
 {
     // Get a new buffer
     ::kaminari::data_wrapper* buffer = kaminari_data_pool.get();
     udp::endpoint* accept_endpoint = endpoints_pool.get();
 
-    _socket.async_receive_from(boost::asio::buffer(buffer->data, 500), *accept_endpoint, 0, [this, buffer, accept_endpoint](const auto& error, std::size_t bytes) {
+    shard->socket.async_receive_from(boost::asio::buffer(buffer->data, MaxDatagramSize), *accept_endpoint, 0, [this, shard, buffer, accept_endpoint](const auto& error, std::size_t bytes) {
         std::cout << "Incoming packet from " << *accept_endpoint << " [" << bytes << "b, " << static_cast<bool>(error) << "]" << std::endl;
 
         if (error)
         {
             kaminari_data_pool.release(buffer);
+            endpoints_pool.release(accept_endpoint);
         }
         else
         {
             // Set read size
             buffer->size = bytes;
+            on_datagram(accept_endpoint, buffer);
+        }
+
+        // Handle again
+        handle_connections(shard);
+    });
+}
+
+void server::handle_connections_batched(network_shard* shard)
+{
+    // Asio only tells us there is something to read, datagrams are then drained in batches
+    shard->socket.async_wait(udp::socket::wait_read, [this, shard](const auto& error) {
+        if (!error)
+        {
+            receive_batch(shard->socket);
+        }
+
+        if (!_stop)
+        {
+            handle_connections_batched(shard);
+        }
+    });
+}
 
-            // Create client
-            bool operation_allowed = server::instance->get_or_create_client(accept_endpoint, [this, accept_endpoint, buffer](auto client) {
-                // Release buffer
-                endpoints_pool.release(accept_endpoint);
+void server::receive_batch(udp::socket& socket)
+{
+#ifdef __linux__
+    // Buffers not filled by a batch are kept for the next one on this same thread
+    thread_local std::array<::kaminari::data_wrapper*, NetworkBatchSize> buffers {};
+    thread_local std::array<udp::endpoint*, NetworkBatchSize> endpoints {};
 
-                // Add packet
-                client->received_packet(boost::intrusive_ptr<::kaminari::data_wrapper>(buffer));
-            });
+    std::array<mmsghdr, NetworkBatchSize> headers;
+    std::array<iovec, NetworkBatchSize> iovecs;
 
-            // Free buffer it it failed
-            if (!operation_allowed)
+    while (true)
+    {
+        for (uint16_t i = 0; i < NetworkBatchSize; ++i)
+        {
+            if (!buffers[i])
             {
-                kaminari_data_pool.release(buffer);
-                endpoints_pool.release(accept_endpoint);
+                buffers[i] = kaminari_data_pool.get();
+                endpoints[i] = endpoints_pool.get();
             }
+
+            iovecs[i] = { .iov_base = buffers[i]->data, .iov_len = MaxDatagramSize };
+            headers[i] = {};
+            headers[i].msg_hdr.msg_name = endpoints[i]->data();
+            headers[i].msg_hdr.msg_namelen = static_cast<socklen_t>(endpoints[i]->capacity());
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
         }
 
-        // Handle again
-        handle_connections();
+        int count = recvmmsg(socket.native_handle(), headers.data(), NetworkBatchSize, MSG_DONTWAIT, nullptr);
+        if (count <= 0)
+        {
+            // Drained (EAGAIN) or another thread got them first
+            return;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            buffers[i]->size = headers[i].msg_len;
+            endpoints[i]->resize(headers[i].msg_hdr.msg_namelen);
+            on_datagram(endpoints[i], buffers[i]);
+
+            // Ownership has been transferred
+            buffers[i] = nullptr;
+            endpoints[i] = nullptr;
+        }
+
+        if (count < NetworkBatchSize)
+        {
+            return;
+        }
+    }
+#endif
+}
+
+void server::on_datagram(udp::endpoint* endpoint, ::kaminari::data_wrapper* buffer)
+{
+    // Known clients are routed directly, without a task
+    if (auto route = _clients.find(*endpoint))
+    {
+        route->inbox->push(boost::intrusive_ptr<::kaminari::data_wrapper>(buffer));
+        endpoints_pool.release(endpoint);
+        return;
+    }
+
+    // Create client
+    bool operation_allowed = server::instance->get_or_create_client(endpoint, [this, endpoint, buffer](auto client) {
+        // Release buffer
+        endpoints_pool.release(endpoint);
+
+        // Add packet
+        client->received_packet(boost::intrusive_ptr<::kaminari::data_wrapper>(buffer));
     });
+
+    // Free buffer it it failed
+    if (!operation_allowed)
+    {
+        kaminari_data_pool.release(buffer);
+        endpoints_pool.release(endpoint);
+    }
 }
 
 void release_data_wrapper(::kaminari::data_wrapper* x)
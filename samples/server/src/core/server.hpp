@@ -6,7 +6,11 @@
 #include "maps/map.hpp"
 
 #include <async/async_executor.hpp>
+#include <containers/completion_queue.hpp>
+#include <containers/concurrent_table.hpp>
+#include <database/query_results.hpp>
 #include <database/transaction.hpp>
+#include <database/write_coalescer.hpp>
 #include <entity/scheme.hpp>
 #include <updater/executor.hpp>
 #include <pools/thread_local_pool.hpp>
@@ -15,8 +19,10 @@
 #include <kumo/rpc.hpp>
 
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <unordered_map>
-#include <unordered_set>
 #include <chrono>
 
 
@@ -47,7 +53,8 @@ public:
     static inline server* instance = nullptr;
 
 public:
-    server(uint16_t port, uint8_t num_server_workers, uint8_t num_network_workers);
+    // With `reuse_port` each network thread gets its own SO_REUSEPORT socket, otherwise all share one
+    server(uint16_t port, uint8_t num_server_workers, uint8_t num_network_workers, network_mode mode = network_mode::asio, bool reuse_port = false);
 
     inline const std_clock_t::time_point& now() const;
 
@@ -76,7 +83,14 @@ public:
     void disconnect_client(client* client);
     void send_client_outputs(client* client);
 
+    // Only does something in batched mode, must be called once all outputs are done
+    void flush_client_outputs();
+
     inline async_executor<(uint16_t)FiberID::DatabaseWorker>& database_async();
+
+    // Database workers push here instead of scheduling a task per result
+    inline completion_queue<entity<client>, login_result>& login_results();
+    inline completion_queue<entity<client>, character_result>& character_results();
     
     template <typename F>
     void schedule(F&& functions);
@@ -85,8 +99,36 @@ public:
     void schedule_if(T&& ticket, F&& functions);
 
 private:
+    struct outgoing_datagram
+    {
+        boost::asio::const_buffer buffer;
+        udp::endpoint endpoint;
+    };
+
+    struct client_route
+    {
+        ticket<entity<client>>::ptr entity_ticket;
+        std::shared_ptr<client_inbox> inbox;
+    };
+
+    struct network_shard
+    {
+        network_shard(uint8_t concurrency, const udp::endpoint& endpoint, bool reuse_port);
+
+        boost::asio::io_context context;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+        udp::socket socket;
+    };
+
     void spawn_network_threads(uint8_t count);
-    void handle_connections();
+    void handle_connections(network_shard* shard);
+    void handle_connections_batched(network_shard* shard);
+    void receive_batch(udp::socket& socket);
+    void on_datagram(udp::endpoint* endpoint, ::kaminari::data_wrapper* buffer);
+    void deliver_database_results();
+
+    inline std::vector<outgoing_datagram>& outgoing_queue() noexcept;
+    inline network_shard& shard_for(const udp::endpoint& endpoint) noexcept;
 
 private:
     // Data schemes
@@ -95,9 +137,9 @@ private:
     decltype(scheme_maker<client>()(_store)) _client_scheme;
     decltype(scheme_maker<transaction>()(_store)) _transaction_scheme;
 
-    // Clients
-    std::unordered_map<udp::endpoint, ticket<entity<client>>::ptr> _clients;
-    std::unordered_set<udp::endpoint> _blacklist;
+    // Clients, written only from tasks but read from network threads too
+    concurrent_table<udp::endpoint, client_route, MaxWorkerThreads> _clients;
+    concurrent_table<udp::endpoint, bool, MaxWorkerThreads> _blacklist;
 
     // Maps
     std::unordered_map<uint64_t, map*> _maps;
@@ -108,12 +150,18 @@ private:
 
     // Networking
     std::vector<std::thread> _network_threads;
-    boost::asio::io_context _context;
-    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> _work;
-    udp::socket _socket;
+    std::vector<std::unique_ptr<network_shard>> _shards;
+    network_mode _network_mode;
+
+    // Batched mode, outputs are queued per worker and flushed at once
+    std::array<std::vector<outgoing_datagram>, MaxWorkerThreads> _outgoing;
+    std::atomic<uint16_t> _outgoing_queues;
 
     // Database
     async_executor<(uint16_t)FiberID::DatabaseWorker> _database_async;
+    write_coalescer _write_coalescer;
+    completion_queue<entity<client>, login_result> _login_results;
+    completion_queue<entity<client>, character_result> _character_results;
 
     // Other
     std_clock_t::time_point _now;
@@ -141,8 +189,7 @@ inline client* server::get_client(uint64_t id) const
 template <typename C>
 bool server::get_or_create_client(udp::endpoint* endpoint, C&& callback)
 {
-    // TODO(gpascualg): This is not thread safe
-    if (auto it = _blacklist.find(*endpoint); it != _blacklist.end())
+    if (_blacklist.contains(*endpoint))
     {
         return false;
     }
@@ -155,7 +202,7 @@ bool server::get_or_create_client(udp::endpoint* endpoint, C&& callback)
         },
         // If created, emplace it in the map
         [this, endpoint](auto client) {
-            _clients.emplace(*endpoint, client->ticket());
+            _clients.insert(*endpoint, { .entity_ticket = client->ticket(), .inbox = client->inbox() });
             std::cout << "NEW CLIENT AT " << client->endpoint() << " (" << *endpoint << ")" << std::endl;
             
             // TODO(gpascualg): This is a test, remove me
@@ -190,11 +237,34 @@ void server::get_or_create_map(uint64_t id, C&& callback)
         _map_scheme.args<map>());
 } 
 
+inline std::vector<server::outgoing_datagram>& server::outgoing_queue() noexcept
+{
+    thread_local uint16_t index = _outgoing_queues++;
+    assert(index < MaxWorkerThreads && "Too many threads sending outputs");
+    return _outgoing[index];
+}
+
+inline server::network_shard& server::shard_for(const udp::endpoint& endpoint) noexcept
+{
+    // Only used for sending, any shard's socket is bound to the same address
+    return *_shards[std::hash<udp::endpoint>{}(endpoint) % _shards.size()];
+}
+
 inline async_executor<(uint16_t)FiberID::DatabaseWorker>& server::database_async()
 {
     return _database_async;
 }
 
+inline completion_queue<entity<client>, login_result>& server::login_results()
+{
+    return _login_results;
+}
+
+inline completion_queue<entity<client>, character_result>& server::character_results()
+{
+    return _character_results;
+}
+
 template <typename F>
 void server::schedule(F&& function)
 {
@@ -1,5 +1,7 @@
+#include "common/definitions.hpp"
 #include "database/database.hpp"
-#include "database/pseudorandom_unique_id.hpp"
+
+#include <cassert>
 
 
 using bsoncxx::builder::basic::make_document;
@@ -11,47 +13,52 @@ void database::initialize(const mongocxx::uri& uri, std::string database, const
 {
     if (instance == nullptr)
     {
-        instance = new class database(uri, database, collections_map);
+        auto mongo = new mongo_backend(uri, database, collections_map);
+        instance = new class database(std::unique_ptr<persistence_backend>(mongo), mongo);
     }
 }
 
-database::database(const mongocxx::uri& uri, std::string database, const std::unordered_map<uint8_t, std::string>& collections_map) :
-    _instance(),
-    _pool(uri),
-    _database(database),
-    _collections_map(collections_map)
+void database::initialize(std::unique_ptr<persistence_backend>&& backend)
+{
+    if (instance == nullptr)
+    {
+        instance = new class database(std::move(backend), nullptr);
+    }
+}
+
+database::database(std::unique_ptr<persistence_backend>&& backend, mongo_backend* mongo) :
+    _backend(std::move(backend)),
+    _mongo(mongo),
+    _cache(DocumentCacheSize, QueryCacheSize),
+    _ids(DatabaseShard, IdReservationSize),
+    _public_ids(PublicIdKey)
 {}
 
 uint64_t database::ensure_creation(uint8_t collection, mongocxx::model::insert_one&& op)
 {
-    auto col = get_collection(collection);
-
+    // Ids are unique within the shard, retrying only covers misconfigured shards or clocks
+    //  going back between runs
     while (true)
     {
         uint64_t id = get_unique_id();
         auto document = make_document(kvp("_id", static_cast<int64_t>(id)), bsoncxx::builder::concatenate(op.document().view()));
-        if (col.insert_one(document.view()))
+        if (_backend->insert(collection, document.view()))
         {
+            // Queries cached before the insert would miss the new document
+            _cache.invalidate_lists(collection);
             return id;
         }
     }
 }
 
-mongocxx::database& database::get_database()
-{
-    thread_local auto client = _pool.acquire();
-    thread_local auto database = client->database(_database);
-    return database;
-}
-
 mongocxx::collection database::get_collection(uint8_t collection)
 {
-    auto& database = get_database();
-    return database[_collections_map[collection]];
+    assert(_mongo && "Queries need the Mongo backend");
+    return _mongo->get_collection(collection);
 }
 
 uint64_t database::get_unique_id()
 {
-    thread_local pseudorandom_unique_id gen;
-    return gen.next();
+    thread_local snowflake_id::reservation block;
+    return _ids.next(block);
 }
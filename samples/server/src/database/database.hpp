@@ -1,6 +1,10 @@
 #pragma once
 
 #include "common/types.hpp"
+#include "database/document_cache.hpp"
+#include "database/mongo_backend.hpp"
+#include "database/persistence_backend.hpp"
+#include "database/snowflake_id.hpp"
 
 #include <mongocxx/bulk_write.hpp>
 #include <mongocxx/pool.hpp>
@@ -11,6 +15,7 @@
 #include <bsoncxx/json.hpp>
 #include <bsoncxx/oid.hpp>
 
+#include <memory>
 #include <set>
 #include <optional>
 #include <unordered_map>
@@ -23,22 +28,50 @@ public:
     static inline database* instance = nullptr;
 
     static void initialize(const mongocxx::uri& uri, std::string database, const std::unordered_map<uint8_t, std::string>& collections_map);
+    static void initialize(std::unique_ptr<persistence_backend>&& backend);
 
     uint64_t ensure_creation(uint8_t collection, mongocxx::model::insert_one&& op);
 
+    inline persistence_backend* backend() const;
+    inline document_cache* cache();
+
+    // Queries are not abstracted, they are only available with the Mongo backend
     mongocxx::collection get_collection(uint8_t collection);
 
     uint64_t get_unique_id();
 
-private:
-    database(const mongocxx::uri& uri, std::string database, const std::unordered_map<uint8_t, std::string>& collections_map);
-
-    mongocxx::database& get_database();
+    // Only ids crossing the network are permuted, the database always sees internal ids
+    inline uint64_t public_id(uint64_t id) const;
+    inline uint64_t internal_id(uint64_t public_id) const;
 
 private:
-    mongocxx::instance _instance;
-    mongocxx::pool _pool;
-    std::string _database;
+    database(std::unique_ptr<persistence_backend>&& backend, mongo_backend* mongo);
 
-    std::unordered_map<uint8_t, std::string> _collections_map;
+private:
+    std::unique_ptr<persistence_backend> _backend;
+    mongo_backend* _mongo;
+    document_cache _cache;
+    snowflake_id _ids;
+    id_permutation _public_ids;
 };
+
+
+inline persistence_backend* database::backend() const
+{
+    return _backend.get();
+}
+
+inline uint64_t database::public_id(uint64_t id) const
+{
+    return _public_ids.encode(id);
+}
+
+inline uint64_t database::internal_id(uint64_t public_id) const
+{
+    return _public_ids.decode(public_id);
+}
+
+inline document_cache* database::cache()
+{
+    return &_cache;
+}
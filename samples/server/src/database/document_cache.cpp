@@ -0,0 +1,425 @@
+#include "database/document_cache.hpp"
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/types.hpp>
+
+#include <cassert>
+#include <limits>
+#include <utility>
+
+
+using bsoncxx::builder::basic::kvp;
+
+
+document_cache::read_scope::read_scope(document_cache* cache, std::multiset<uint64_t>::iterator it) :
+    _cache(cache),
+    _it(it)
+{}
+
+document_cache::read_scope::read_scope(read_scope&& other) noexcept :
+    _cache(std::exchange(other._cache, nullptr)),
+    _it(other._it)
+{}
+
+document_cache::read_scope::~read_scope()
+{
+    if (_cache)
+    {
+        _cache->end_read(_it);
+    }
+}
+
+document_cache::document_cache(std::size_t documents_capacity, std::size_t lists_capacity) :
+    _mutex(),
+    _documents(documents_capacity),
+    _lists(lists_capacity),
+    _version(0),
+    _reads(),
+    _writes(),
+    _collection_writes()
+{}
+
+document_cache::read_scope document_cache::begin_read()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return read_scope(this, _reads.insert(_version));
+}
+
+void document_cache::end_read(std::multiset<uint64_t>::iterator it)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    bool oldest = it == _reads.begin();
+    _reads.erase(it);
+
+    // Writes are only tracked while some read might have missed them
+    if (oldest)
+    {
+        prune_writes();
+    }
+}
+
+std::optional<bsoncxx::document::value> document_cache::find(uint8_t collection, int64_t id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (auto document = _documents.get({ .collection = collection, .id = id }))
+    {
+        return *document;
+    }
+
+    return std::nullopt;
+}
+
+void document_cache::store(const read_scope& read, uint8_t collection, bsoncxx::document::view document)
+{
+    auto id = id_of(document);
+    if (!id)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (is_stale(*read._it, collection, *id))
+    {
+        return;
+    }
+
+    _documents.put({ .collection = collection, .id = *id }, bsoncxx::document::value(document), document.length());
+}
+
+std::optional<std::vector<bsoncxx::document::value>> document_cache::find_list(uint8_t collection, const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto ids = _lists.get({ .collection = collection, .key = key });
+    if (!ids)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<bsoncxx::document::value> documents;
+    documents.reserve(ids->size());
+
+    for (auto id : *ids)
+    {
+        auto document = _documents.get({ .collection = collection, .id = id });
+        if (!document)
+        {
+            // Partially evicted, it will be queried again
+            _lists.erase({ .collection = collection, .key = key });
+            return std::nullopt;
+        }
+
+        documents.push_back(*document);
+    }
+
+    return documents;
+}
+
+void document_cache::store_list(const read_scope& read, uint8_t collection, const std::string& key, const std::vector<bsoncxx::document::view>& documents)
+{
+    std::vector<int64_t> ids;
+    ids.reserve(documents.size());
+
+    for (auto document : documents)
+    {
+        auto id = id_of(document);
+        if (!id)
+        {
+            return;
+        }
+
+        ids.push_back(*id);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Inserts and deletes not yet seen by the query change which documents it returns
+    if (auto it = _collection_writes.find(collection); it != _collection_writes.end() && is_stale(*read._it, it->second.membership))
+    {
+        return;
+    }
+
+    for (auto id : ids)
+    {
+        if (is_stale(*read._it, collection, id))
+        {
+            return;
+        }
+    }
+
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        _documents.put({ .collection = collection, .id = ids[i] }, bsoncxx::document::value(documents[i]), documents[i].length());
+    }
+
+    const std::size_t size = key.size() + ids.size() * sizeof(int64_t);
+    _lists.put({ .collection = collection, .key = key }, std::move(ids), size);
+}
+
+document_cache::pending_write document_cache::apply(uint8_t collection, const mongocxx::model::write& operation)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    pending_write write { .collection = collection };
+
+    switch (operation.type())
+    {
+        case mongocxx::write_type::k_insert_one:
+        {
+            // Query results might now be missing it
+            _lists.clear();
+            write.membership = true;
+
+            auto document = operation.get_insert_one().document().view();
+            if (auto id = id_of(document))
+            {
+                _documents.put({ .collection = collection, .id = *id }, bsoncxx::document::value(document), document.length());
+                write.id = id;
+            }
+            break;
+        }
+
+        case mongocxx::write_type::k_update_one:
+        {
+            auto& update = operation.get_update_one();
+            write.id = filter_id(update.filter().view());
+            if (write.id)
+            {
+                apply_update({ .collection = collection, .id = *write.id }, update.update().view());
+            }
+            else
+            {
+                invalidate(collection, update.filter().view());
+            }
+            break;
+        }
+
+        case mongocxx::write_type::k_replace_one:
+            write.id = filter_id(operation.get_replace_one().filter().view());
+            invalidate(collection, operation.get_replace_one().filter().view());
+            break;
+
+        case mongocxx::write_type::k_update_many:
+            write.id = filter_id(operation.get_update_many().filter().view());
+            invalidate(collection, operation.get_update_many().filter().view());
+            break;
+
+        case mongocxx::write_type::k_delete_one:
+            _lists.clear();
+            write.id = filter_id(operation.get_delete_one().filter().view());
+            write.membership = true;
+            invalidate(collection, operation.get_delete_one().filter().view());
+            break;
+
+        case mongocxx::write_type::k_delete_many:
+            _lists.clear();
+            write.id = filter_id(operation.get_delete_many().filter().view());
+            write.membership = true;
+            invalidate(collection, operation.get_delete_many().filter().view());
+            break;
+    }
+
+    // Inserts without an id can not change any existing document
+    write.any_document = !write.id && operation.type() != mongocxx::write_type::k_insert_one;
+
+    if (write.id)
+    {
+        queue(_writes[{ .collection = collection, .id = *write.id }]);
+    }
+
+    if (write.any_document)
+    {
+        queue(_collection_writes[collection].documents);
+    }
+
+    if (write.membership)
+    {
+        queue(_collection_writes[collection].membership);
+    }
+
+    return write;
+}
+
+void document_cache::acknowledge(const pending_write& write)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (write.id)
+    {
+        const document_key key { .collection = write.collection, .id = *write.id };
+        if (auto it = _writes.find(key); it != _writes.end())
+        {
+            release(it->second);
+
+            // No longer needed if there are no reads which could have missed it
+            if (it->second.pending == 0 && (_reads.empty() || it->second.version <= *_reads.begin()))
+            {
+                _writes.erase(it);
+            }
+        }
+    }
+
+    if (write.any_document)
+    {
+        release(_collection_writes[write.collection].documents);
+    }
+
+    if (write.membership)
+    {
+        release(_collection_writes[write.collection].membership);
+    }
+}
+
+void document_cache::invalidate_lists(uint8_t collection)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _lists.clear();
+
+    // Already written, but queries in flight might not include it
+    _collection_writes[collection].membership.version = ++_version;
+}
+
+void document_cache::apply_update(const document_key& key, bsoncxx::document::view update)
+{
+    auto cached = _documents.get(key);
+    if (!cached || update.empty())
+    {
+        return;
+    }
+
+    bsoncxx::builder::basic::document builder;
+    bsoncxx::document::view current = cached->view();
+
+    if (update.begin()->key().front() != '$')
+    {
+        // Replacement document, only the id is kept
+        builder.append(kvp("_id", current["_id"].get_value()));
+        for (auto element : update)
+        {
+            builder.append(kvp(element.key(), element.get_value()));
+        }
+    }
+    else
+    {
+        // Only top level $set is understood, anything else is left to the database
+        for (auto element : update)
+        {
+            if (element.key() != "$set" || element.type() != bsoncxx::type::k_document)
+            {
+                _documents.erase(key);
+                return;
+            }
+        }
+
+        auto changes = update["$set"].get_document().value;
+        for (auto element : changes)
+        {
+            if (element.key().find('.') != decltype(element.key())::npos)
+            {
+                _documents.erase(key);
+                return;
+            }
+        }
+
+        for (auto element : current)
+        {
+            if (!changes[element.key()])
+            {
+                builder.append(kvp(element.key(), element.get_value()));
+            }
+        }
+
+        for (auto element : changes)
+        {
+            builder.append(kvp(element.key(), element.get_value()));
+        }
+    }
+
+    auto document = builder.extract();
+    const std::size_t size = document.view().length();
+    _documents.put(key, std::move(document), size);
+}
+
+void document_cache::invalidate(uint8_t collection, bsoncxx::document::view filter)
+{
+    if (auto id = filter_id(filter))
+    {
+        _documents.erase({ .collection = collection, .id = *id });
+    }
+    else
+    {
+        // Can't know which documents match
+        _documents.clear();
+    }
+}
+
+void document_cache::prune_writes()
+{
+    const uint64_t oldest = _reads.empty() ? std::numeric_limits<uint64_t>::max() : *_reads.begin();
+    std::erase_if(_writes, [oldest](const auto& entry) {
+        return entry.second.pending == 0 && entry.second.version <= oldest;
+    });
+}
+
+bool document_cache::is_stale(uint64_t version, uint8_t collection, int64_t id) const
+{
+    if (auto it = _collection_writes.find(collection); it != _collection_writes.end() && is_stale(version, it->second.documents))
+    {
+        return true;
+    }
+
+    auto it = _writes.find({ .collection = collection, .id = id });
+    return it != _writes.end() && is_stale(version, it->second);
+}
+
+bool document_cache::is_stale(uint64_t version, const write_state& state) const
+{
+    // Either the write is still on its way, or it changed while reading
+    return state.pending > 0 || state.version > version;
+}
+
+void document_cache::queue(write_state& state)
+{
+    ++state.pending;
+    state.version = ++_version;
+}
+
+void document_cache::release(write_state& state)
+{
+    assert(state.pending > 0 && "Acknowledging a write that was not queued");
+    --state.pending;
+    state.version = ++_version;
+}
+
+std::optional<int64_t> document_cache::id_of(bsoncxx::document::view document)
+{
+    auto id = document["_id"];
+    if (!id)
+    {
+        return std::nullopt;
+    }
+
+    switch (id.type())
+    {
+        case bsoncxx::type::k_int64:
+            return id.get_int64().value;
+
+        case bsoncxx::type::k_int32:
+            return id.get_int32().value;
+
+        default:
+            return std::nullopt;
+    }
+}
+
+std::optional<int64_t> document_cache::filter_id(bsoncxx::document::view filter)
+{
+    // Only filters that are exactly { _id: X } are known to match a single, given, document
+    if (std::distance(filter.begin(), filter.end()) != 1)
+    {
+        return std::nullopt;
+    }
+
+    return id_of(filter);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <containers/lru_cache.hpp>
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <mongocxx/model/write.hpp>
+
+#include <inttypes.h>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// Write-behind cache in front of the persistence backend. Documents are keyed by their
+//  `_id`, transactions apply their writes here as soon as they are queued, so reads
+//  served from memory already see them while the database catches up
+//  Lists of ids cache the result of queries, ie. the characters of an account
+//  Writes stay pending until the database acknowledges them, reads done meanwhile might
+//  not see them and are not cached
+class document_cache
+{
+    // Queued and not yet acknowledged writes, and the version of the last one queued or
+    //  acknowledged. Reads started before that version might have missed the write
+    struct write_state
+    {
+        uint32_t pending = 0;
+        uint64_t version = 0;
+    };
+
+    struct collection_writes
+    {
+        // Writes which can not be tied to a single document
+        write_state documents;
+
+        // Inserts and deletes, they change the result of queries
+        write_state membership;
+    };
+
+    struct document_key
+    {
+        bool operator==(const document_key& other) const = default;
+
+        uint8_t collection;
+        int64_t id;
+    };
+
+    struct list_key
+    {
+        bool operator==(const list_key& other) const = default;
+
+        uint8_t collection;
+        std::string key;
+    };
+
+    struct key_hash
+    {
+        inline std::size_t operator()(const document_key& key) const noexcept
+        {
+            return std::hash<int64_t>{}(key.id) ^ (static_cast<std::size_t>(key.collection) << 56);
+        }
+
+        inline std::size_t operator()(const list_key& key) const noexcept
+        {
+            return std::hash<std::string>{}(key.key) ^ (static_cast<std::size_t>(key.collection) << 56);
+        }
+    };
+
+public:
+    // What a queued write touches, handed back once the database has executed it
+    struct pending_write
+    {
+        uint8_t collection = 0;
+        std::optional<int64_t> id = std::nullopt;
+        bool any_document = false;
+        bool membership = false;
+    };
+
+    // Database reads whose results are to be stored must be started before querying
+    class read_scope
+    {
+        friend class document_cache;
+
+    public:
+        read_scope(read_scope&& other) noexcept;
+        read_scope(const read_scope&) = delete;
+        ~read_scope();
+
+    private:
+        read_scope(document_cache* cache, std::multiset<uint64_t>::iterator it);
+
+    private:
+        document_cache* _cache;
+        std::multiset<uint64_t>::iterator _it;
+    };
+
+public:
+    // Capacities are in bytes
+    document_cache(std::size_t documents_capacity, std::size_t lists_capacity);
+
+    read_scope begin_read();
+
+    std::optional<bsoncxx::document::value> find(uint8_t collection, int64_t id);
+
+    // Results are dropped if a write to them was queued before the read finished
+    void store(const read_scope& read, uint8_t collection, bsoncxx::document::view document);
+
+    // Only returns lists whose documents are all cached
+    std::optional<std::vector<bsoncxx::document::value>> find_list(uint8_t collection, const std::string& key);
+    void store_list(const read_scope& read, uint8_t collection, const std::string& key, const std::vector<bsoncxx::document::view>& documents);
+
+    // Called when the operation is queued, anything that can not be applied invalidates
+    pending_write apply(uint8_t collection, const mongocxx::model::write& operation);
+
+    // Called once the database has executed, or dropped, the operation
+    void acknowledge(const pending_write& write);
+
+    // Documents written to the database without going through `apply`
+    void invalidate_lists(uint8_t collection);
+
+private:
+    void end_read(std::multiset<uint64_t>::iterator it);
+    void prune_writes();
+
+    bool is_stale(uint64_t version, uint8_t collection, int64_t id) const;
+    bool is_stale(uint64_t version, const write_state& state) const;
+    void queue(write_state& state);
+    void release(write_state& state);
+
+    void apply_update(const document_key& key, bsoncxx::document::view update);
+    void invalidate(uint8_t collection, bsoncxx::document::view filter);
+
+    static std::optional<int64_t> id_of(bsoncxx::document::view document);
+    static std::optional<int64_t> filter_id(bsoncxx::document::view filter);
+
+private:
+    std::mutex _mutex;
+    lru_cache<document_key, bsoncxx::document::value, key_hash> _documents;
+    lru_cache<list_key, std::vector<int64_t>, key_hash> _lists;
+
+    uint64_t _version;
+    std::multiset<uint64_t> _reads;
+    std::unordered_map<document_key, write_state, key_hash> _writes;
+    std::unordered_map<uint8_t, collection_writes> _collection_writes;
+};
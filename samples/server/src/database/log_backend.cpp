@@ -0,0 +1,103 @@
+#include "database/log_backend.hpp"
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+
+#include <cassert>
+#include <string>
+#include <thread>
+
+
+using bsoncxx::builder::basic::make_document;
+using bsoncxx::builder::basic::kvp;
+
+
+log_backend::log_backend(std::chrono::microseconds round_trip, std::chrono::microseconds per_operation) :
+    _round_trip(round_trip),
+    _per_operation(per_operation),
+    _mutex(),
+    _records(),
+    _inserted_ids(),
+    _sequence(0),
+    _round_trips(0)
+{}
+
+void log_backend::bulk_write(uint8_t collection, std::vector<mongocxx::model::write>&& operations)
+{
+    simulate_latency(operations.size());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_round_trips;
+
+    for (const auto& operation : operations)
+    {
+        append(collection, operation);
+    }
+}
+
+bool log_backend::insert(uint8_t collection, bsoncxx::document::view document)
+{
+    simulate_latency(1);
+
+    auto id = document["_id"];
+    assert(id && "Inserted documents must have an _id");
+
+    // Compare ids by their BSON encoding, so that any type works
+    auto key = make_document(kvp("_id", id.get_value()));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_round_trips;
+
+    if (!_inserted_ids[collection].emplace(reinterpret_cast<const char*>(key.view().data()), key.view().length()).second)
+    {
+        return false;
+    }
+
+    append(collection, mongocxx::model::insert_one(document));
+    return true;
+}
+
+void log_backend::simulate_latency(std::size_t operations) const
+{
+    const auto latency = _round_trip + _per_operation * operations;
+    if (latency.count() > 0)
+    {
+        std::this_thread::sleep_for(latency);
+    }
+}
+
+void log_backend::append(uint8_t collection, const mongocxx::model::write& operation)
+{
+    auto copy = [](bsoncxx::document::view view) {
+        return bsoncxx::document::value(view);
+    };
+
+    const bsoncxx::document::view empty {};
+
+    switch (operation.type())
+    {
+        case mongocxx::write_type::k_insert_one:
+            _records[collection].push_back({ _sequence++, operation.type(), copy(empty), copy(operation.get_insert_one().document()) });
+            break;
+
+        case mongocxx::write_type::k_delete_one:
+            _records[collection].push_back({ _sequence++, operation.type(), copy(operation.get_delete_one().filter()), copy(empty) });
+            break;
+
+        case mongocxx::write_type::k_delete_many:
+            _records[collection].push_back({ _sequence++, operation.type(), copy(operation.get_delete_many().filter()), copy(empty) });
+            break;
+
+        case mongocxx::write_type::k_update_one:
+            _records[collection].push_back({ _sequence++, operation.type(), copy(operation.get_update_one().filter()), copy(operation.get_update_one().update()) });
+            break;
+
+        case mongocxx::write_type::k_update_many:
+            _records[collection].push_back({ _sequence++, operation.type(), copy(operation.get_update_many().filter()), copy(operation.get_update_many().update()) });
+            break;
+
+        case mongocxx::write_type::k_replace_one:
+            _records[collection].push_back({ _sequence++, operation.type(), copy(operation.get_replace_one().filter()), copy(operation.get_replace_one().replacement()) });
+            break;
+    }
+}
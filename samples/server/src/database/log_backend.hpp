@@ -0,0 +1,64 @@
+#pragma once
+
+#include "database/persistence_backend.hpp"
+
+#include <bsoncxx/document/value.hpp>
+#include <mongocxx/write_type.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+// In-process append-only log of every write, to run and measure transactions without a
+//  live Mongo. Each call sleeps for a simulated round trip before appending
+class log_backend : public persistence_backend
+{
+public:
+    struct record
+    {
+        uint64_t sequence;
+        mongocxx::write_type type;
+
+        // Empty when the operation has no filter (inserts) or no document (deletes)
+        bsoncxx::document::value filter;
+        bsoncxx::document::value document;
+    };
+
+    log_backend(std::chrono::microseconds round_trip = std::chrono::microseconds(0), std::chrono::microseconds per_operation = std::chrono::microseconds(0));
+
+    void bulk_write(uint8_t collection, std::vector<mongocxx::model::write>&& operations) override;
+    bool insert(uint8_t collection, bsoncxx::document::view document) override;
+
+    // Not thread safe, only call once writers are done
+    inline const std::vector<record>& records(uint8_t collection);
+    inline uint64_t round_trips() const;
+
+private:
+    void simulate_latency(std::size_t operations) const;
+    void append(uint8_t collection, const mongocxx::model::write& operation);
+
+private:
+    std::chrono::microseconds _round_trip;
+    std::chrono::microseconds _per_operation;
+
+    std::mutex _mutex;
+    std::unordered_map<uint8_t, std::vector<record>> _records;
+    std::unordered_map<uint8_t, std::unordered_set<std::string>> _inserted_ids;
+    uint64_t _sequence;
+    uint64_t _round_trips;
+};
+
+
+inline const std::vector<log_backend::record>& log_backend::records(uint8_t collection)
+{
+    return _records[collection];
+}
+
+inline uint64_t log_backend::round_trips() const
+{
+    return _round_trips;
+}
@@ -0,0 +1,60 @@
+#include "database/mongo_backend.hpp"
+
+#include <mongocxx/exception/bulk_write_exception.hpp>
+
+
+mongo_backend::mongo_backend(const mongocxx::uri& uri, std::string database, const std::unordered_map<uint8_t, std::string>& collections_map) :
+    _instance(),
+    _pool(uri),
+    _database(database),
+    _collections_map(collections_map)
+{}
+
+void mongo_backend::bulk_write(uint8_t collection, std::vector<mongocxx::model::write>&& operations)
+{
+    auto col = get_collection(collection);
+    auto bulk = col.create_bulk_write();
+
+    for (auto& operation : operations)
+    {
+        bulk.append(std::move(operation));
+    }
+
+    bulk.execute();
+}
+
+bool mongo_backend::insert(uint8_t collection, bsoncxx::document::view document)
+{
+    // Server error code of unique index violations
+    constexpr int duplicate_key = 11000;
+
+    try
+    {
+        // Unacknowledged writes return no result, but can not be told apart from success
+        get_collection(collection).insert_one(document);
+        return true;
+    }
+    catch (const mongocxx::bulk_write_exception& e)
+    {
+        // Callers retry on false, anything else would fail again and again
+        if (e.code().value() != duplicate_key)
+        {
+            throw;
+        }
+
+        return false;
+    }
+}
+
+mongocxx::database& mongo_backend::get_database()
+{
+    thread_local auto client = _pool.acquire();
+    thread_local auto database = client->database(_database);
+    return database;
+}
+
+mongocxx::collection mongo_backend::get_collection(uint8_t collection)
+{
+    auto& database = get_database();
+    return database[_collections_map[collection]];
+}
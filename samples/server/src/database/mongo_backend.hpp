@@ -0,0 +1,33 @@
+#pragma once
+
+#include "database/persistence_backend.hpp"
+
+#include <mongocxx/pool.hpp>
+#include <mongocxx/client.hpp>
+#include <mongocxx/instance.hpp>
+#include <mongocxx/uri.hpp>
+
+#include <string>
+#include <unordered_map>
+
+
+class mongo_backend : public persistence_backend
+{
+public:
+    mongo_backend(const mongocxx::uri& uri, std::string database, const std::unordered_map<uint8_t, std::string>& collections_map);
+
+    void bulk_write(uint8_t collection, std::vector<mongocxx::model::write>&& operations) override;
+    bool insert(uint8_t collection, bsoncxx::document::view document) override;
+
+    mongocxx::collection get_collection(uint8_t collection);
+
+private:
+    mongocxx::database& get_database();
+
+private:
+    mongocxx::instance _instance;
+    mongocxx::pool _pool;
+    std::string _database;
+
+    std::unordered_map<uint8_t, std::string> _collections_map;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <bsoncxx/document/view.hpp>
+#include <mongocxx/model/write.hpp>
+
+#include <inttypes.h>
+#include <vector>
+
+
+// Storage transactions and the database write to. Writes are expressed as Mongo models,
+//  which are plain BSON, so non-Mongo backends only need to interpret them
+//  Methods are called from the database async executor threads and must be thread safe
+class persistence_backend
+{
+public:
+    virtual ~persistence_backend() = default;
+
+    // Executes all operations in order, returning once they are all done
+    virtual void bulk_write(uint8_t collection, std::vector<mongocxx::model::write>&& operations) = 0;
+
+    // Returns false if a document with the same `_id` already exists, any other error is fatal
+    virtual bool insert(uint8_t collection, bsoncxx::document::view document) = 0;
+};
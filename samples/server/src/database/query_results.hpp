@@ -0,0 +1,27 @@
+#pragma once
+
+#include <kumo/structs.hpp>
+
+#include <glm/glm.hpp>
+
+#include <inttypes.h>
+#include <vector>
+
+
+// Results of queries done in database workers on behalf of a client, they are handed back
+//  to the game thread through the server completion queues
+
+struct login_result
+{
+    // Same as the login response, 0 on success
+    uint8_t code;
+    std::vector<kumo::character> characters;
+};
+
+struct character_result
+{
+    bool found;
+    uint64_t map_id;
+    uint64_t db_id;
+    glm::vec3 position;
+};
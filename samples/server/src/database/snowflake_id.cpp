@@ -0,0 +1,110 @@
+#include "database/snowflake_id.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+
+snowflake_id::snowflake_id(uint16_t shard, uint32_t block_size) noexcept :
+    _shard(shard),
+    _block_size(block_size),
+    _last(0)
+{
+    assert(shard < (1 << ShardBits) && "Shard does not fit in the id");
+    assert(block_size > 0 && block_size <= (1 << SequenceBits) && "Blocks must fit in a millisecond worth of sequences");
+}
+
+void snowflake_id::reserve(reservation& block) noexcept
+{
+    const uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    assert(now > Epoch && "Clock is before the id epoch");
+
+    const uint64_t earliest = (now - Epoch) << SequenceBits;
+
+    // Ranges never overlap, each one starts at or after the end of the previous
+    uint64_t last = _last.load(std::memory_order_relaxed);
+    uint64_t start;
+    do
+    {
+        start = std::max(earliest, last);
+    } while (!_last.compare_exchange_weak(last, start + _block_size, std::memory_order_relaxed));
+
+    assert(((start + _block_size) >> (SequenceBits + TimeBits)) == 0 && "Ran out of timestamp bits");
+
+    block.next = start;
+    block.end = start + _block_size;
+}
+
+
+namespace
+{
+    uint64_t splitmix(uint64_t& state) noexcept
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+    inline uint32_t round_function(uint32_t value, uint32_t key) noexcept
+    {
+        value ^= key;
+        value ^= value >> 16;
+        value *= 0x7FEB352D;
+        value ^= value >> 15;
+        value *= 0x846CA68B;
+        return value ^ (value >> 16);
+    }
+}
+
+id_permutation::id_permutation(uint64_t key) noexcept
+{
+    for (auto& round_key : _keys)
+    {
+        round_key = static_cast<uint32_t>(splitmix(key));
+    }
+}
+
+uint64_t id_permutation::encode(uint64_t id) const noexcept
+{
+    assert((id >> 63) == 0 && "Only positive ids can be permuted");
+
+    // Cycle walking, the network permutes 64 bits, repeat until back in the positive range
+    do
+    {
+        uint32_t left = static_cast<uint32_t>(id >> 32);
+        uint32_t right = static_cast<uint32_t>(id);
+        for (uint8_t i = 0; i < Rounds; ++i)
+        {
+            const uint32_t next = left ^ round_function(right, _keys[i]);
+            left = right;
+            right = next;
+        }
+
+        id = (static_cast<uint64_t>(left) << 32) | right;
+    } while (id >> 63);
+
+    return id;
+}
+
+uint64_t id_permutation::decode(uint64_t id) const noexcept
+{
+    assert((id >> 63) == 0 && "Only positive ids can be permuted");
+
+    do
+    {
+        uint32_t left = static_cast<uint32_t>(id >> 32);
+        uint32_t right = static_cast<uint32_t>(id);
+        for (uint8_t i = Rounds; i > 0; --i)
+        {
+            const uint32_t previous = right ^ round_function(left, _keys[i - 1]);
+            right = left;
+            left = previous;
+        }
+
+        id = (static_cast<uint64_t>(left) << 32) | right;
+    } while (id >> 63);
+
+    return id;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <inttypes.h>
+
+
+// Unique ids laid out as [ 1 unused | 41 ms since epoch | 10 shard | 12 sequence ], ids stay
+//  positive as int64, are roughly time ordered and never collide as long as every process
+//  writing the same database has its own shard and clocks do not go back between runs
+//  Threads reserve blocks of consecutive (time, sequence) pairs from a shared counter, the
+//  clock and the atomic are only touched once per block. Producing more than 4096 ids per
+//  millisecond borrows sequences from the next one instead of waiting
+class snowflake_id
+{
+public:
+    static constexpr uint8_t SequenceBits = 12;
+    static constexpr uint8_t ShardBits = 10;
+    static constexpr uint8_t TimeBits = 41;
+
+    // 2020-01-01T00:00:00Z in ms
+    static constexpr uint64_t Epoch = 1577836800000;
+
+    // Owned by a single thread, usually `thread_local`
+    struct reservation
+    {
+        uint64_t next = 0;
+        uint64_t end = 0;
+    };
+
+    snowflake_id(uint16_t shard, uint32_t block_size = 256) noexcept;
+
+    inline uint64_t next(reservation& block) noexcept;
+
+    static inline uint64_t timestamp_of(uint64_t id) noexcept;
+    static inline uint16_t shard_of(uint64_t id) noexcept;
+
+private:
+    void reserve(reservation& block) noexcept;
+
+private:
+    const uint64_t _shard;
+    const uint32_t _block_size;
+
+    // Last (time << SequenceBits | sequence) handed to any reservation
+    alignas(64) std::atomic<uint64_t> _last;
+};
+
+// Keyed bijection over positive int64 values, for ids shown to clients so they do not leak
+//  creation time, shard or creation rate. Feistel network with cycle walking, `decode`
+//  reverses `encode` given the same key
+class id_permutation
+{
+public:
+    static constexpr uint8_t Rounds = 4;
+
+    id_permutation(uint64_t key) noexcept;
+
+    uint64_t encode(uint64_t id) const noexcept;
+    uint64_t decode(uint64_t id) const noexcept;
+
+private:
+    uint32_t _keys[Rounds];
+};
+
+
+inline uint64_t snowflake_id::next(reservation& block) noexcept
+{
+    if (block.next == block.end)
+    {
+        reserve(block);
+    }
+
+    const uint64_t counter = block.next++;
+    return ((counter >> SequenceBits) << (ShardBits + SequenceBits)) |
+        (_shard << SequenceBits) |
+        (counter & ((uint64_t(1) << SequenceBits) - 1));
+}
+
+inline uint64_t snowflake_id::timestamp_of(uint64_t id) noexcept
+{
+    return (id >> (ShardBits + SequenceBits)) + Epoch;
+}
+
+inline uint16_t snowflake_id::shard_of(uint64_t id) noexcept
+{
+    return static_cast<uint16_t>((id >> SequenceBits) & ((uint64_t(1) << ShardBits) - 1));
+}
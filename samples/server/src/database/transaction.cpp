@@ -2,14 +2,24 @@
 
 #include "database/transaction.hpp"
 #include "database/database.hpp"
+#include "database/write_coalescer.hpp"
 #include "async/async_executor.hpp"
 #include "containers/static_store.hpp"
 #include "updater/executor_registry.hpp"
 
+#include <algorithm>
+
+
+fold_key::fold_key(uint64_t document, std::string_view field) :
+    document(document),
+    field(field)
+{}
 
 transaction::collection_info::collection_info() :
-    first_id(0),
-    current_id(0)
+    next(0),
+    log(),
+    latest(),
+    superseded_by()
 {}
 
 transaction::transaction() noexcept
@@ -29,32 +39,12 @@ void transaction::construct(uint64_t execute_every)
     _scheduled = false;
 }
 
-void transaction::update(uint64_t diff, store_t* store, async_executor_base* async)
+void transaction::update(uint64_t diff, store_t* store, async_executor_base* async, write_coalescer* coalescer)
 {
-    if (_flagged)
+    // Waiting for removal, see `sync`
+    if (_scheduled)
     {
-        if (_scheduled)
-        {
-            return;
-        }
-
-        bool can_delete = true;
-
-        // We will only delete if all transactions are done
-        for (auto& [collection, info] : _collections)
-        {
-            if (info.first_id != info.current_id || !info.transactions[info.current_id].done)
-            {
-                can_delete = false;
-                break;
-            }
-        }
-
-        if (can_delete)
-        {
-            server::instance->schedule_entity_transaction_removal(this);
-            _scheduled = true;
-        }
+        return;
     }
 
     // We have to execute if
@@ -67,65 +57,38 @@ void transaction::update(uint64_t diff, store_t* store, async_executor_base* asy
     }
     _since_last_execution = 0;
 
-    // Transactions are pending when ids don't match
+    // Transactions are pending when there are entries not yet sent
     for (auto& [collection, info] : _collections)
     {
-        if (info.first_id != info.current_id)
+        if (info.next != info.log.end())
         {
             bool has_non_callable_transactions;
             std::vector<transaction_info*> transactions = get_pending_operations(collection, store, has_non_callable_transactions);
-            auto final_id = info.first_id;
             
             if (transactions.empty())
             {
-                break;
+                continue;
             }
 
-            // Everything is write ops
+            // Everything is write ops, sent together with every other transaction's
             if (has_non_callable_transactions)
             {
-                async->submit([
-                    info = &info,
-                    collection = collection,
-                    transactions = std::move(transactions)
-                ]()
-                {
-                    auto col = database::instance->get_collection(collection);
-                    auto bulk = col.create_bulk_write();
-
-                    for (auto t : transactions)
-                    {
-                        bulk.append(std::move(*t->operation));
-                    }
-
-                    // Send transactions
-                    bulk.execute();
-
-                    // Once we get here, they are all executed, so flag them
-                    for (auto t : transactions)
-                    {
-                        t->done = true;
-                        t->pending = false;
-                    }
-                });
+                coalescer->push(collection, std::move(transactions));
             }
             // Everything is callable ops
             else
             {
                 async->submit([
                     this,
-                    info = &info,
-                    collection = collection,
                     transactions = std::move(transactions)
                 ]()
                 {
-                    auto col = database::instance->get_collection(collection);
+                    auto backend = database::instance->backend();
 
                     for (auto t : transactions)
                     {
-                        std::move(*t->callable)(col);
-                        t->done = true;
-                        t->pending = false;
+                        std::move(std::get<callable_t>(t->payload))(backend);
+                        t->mark_done();
                         --_pending_callables;
                     }
                 });
@@ -134,97 +97,137 @@ void transaction::update(uint64_t diff, store_t* store, async_executor_base* asy
     }
 }
 
+void transaction::sync()
+{
+    // Completed operations, and met dependencies, are dropped from the logs. Done serially,
+    //  as other transactions look up entries of this one while resolving their dependencies
+    for (auto& [collection, info] : _collections)
+    {
+        info.log.truncate_while([](const transaction_info& transaction) {
+            return transaction.done();
+        });
+
+        // Once the write they were folded into is done, so is any dependency on them
+        std::erase_if(info.superseded_by, [&info](const auto& entry) {
+            return resolve(info, entry.first) < info.log.first();
+        });
+    }
+
+    if (_flagged && !_scheduled)
+    {
+        // We will only delete if all transactions are done
+        bool can_delete = std::all_of(_collections.begin(), _collections.end(), [](const auto& entry) {
+            return entry.second.log.empty();
+        });
+
+        if (can_delete)
+        {
+            server::instance->schedule_entity_transaction_removal(this);
+            _scheduled = true;
+        }
+    }
+}
+
 uint64_t transaction::push_operation(uint8_t collection, mongocxx::model::write&& operation)
 {
+    // Reads served from the cache see the write before the database does
+    auto cached = database::instance->cache()->apply(collection, operation);
+    return _collections[collection].log.emplace(std::move(operation), cached);
+}
+
+uint64_t transaction::push_operation(uint8_t collection, const fold_key& key, mongocxx::model::write&& operation)
+{
+    auto cached = database::instance->cache()->apply(collection, operation);
+
     collection_info& info = _collections[collection];
-    uint64_t slot = ++info.current_id;
-    transaction_info* transaction = &info.transactions[slot];
+    uint64_t slot = info.log.emplace(std::move(operation), cached);
+
+    // Superseded writes are simply flagged as done, they are skipped when sending
+    auto [it, inserted] = info.latest.try_emplace(key, slot);
+    if (!inserted)
+    {
+        if (it->second >= info.next)
+        {
+            auto superseded = info.log.get(it->second);
+            database::instance->cache()->acknowledge(superseded->cached);
+            superseded->mark_done();
+
+            // Dependencies on it now wait for the new write
+            info.superseded_by.emplace(it->second, slot);
+        }
 
-    transaction->dependency = std::nullopt;
-    transaction->operation = std::move(operation);
-    transaction->callable = std::nullopt;
-    transaction->done = false;
-    transaction->pending = false;
+        it->second = slot;
+    }
 
     return slot;
 }
 
 uint64_t transaction::push_callable(uint8_t collection, callable_t&& callable)
 {
+    // Callables might read anything written before, nothing can be folded over them
     collection_info& info = _collections[collection];
-    uint64_t slot = ++info.current_id;
-    transaction_info* transaction = &info.transactions[slot];
-
-    transaction->dependency = std::nullopt;
-    transaction->operation = std::nullopt;
-    transaction->callable = std::move(callable);
-    transaction->done = false;
-    transaction->pending = false;
-    ++_pending_callables;
+    info.latest.clear();
 
-    return slot;
+    ++_pending_callables;
+    return info.log.emplace(std::move(callable));
 }
 
 void transaction::push_dependency(uint8_t collection, uint64_t owner, uint64_t id)
 {
+    // Others wait on this point, writes before it must reach the database
     collection_info& info = _collections[collection];
-    uint64_t slot = ++info.current_id;
-    transaction_info* transaction = &info.transactions[slot];
-
-    transaction->dependency = { .owner = owner, .id = id };
-    transaction->operation = std::nullopt;
-    transaction->callable = std::nullopt;
-    transaction->done = false;
-    transaction->pending = false;
+    info.latest.clear();
+
+    info.log.emplace(dependency { .owner = owner, .id = id });
 }
 
 std::vector<transaction::transaction_info*> transaction::get_pending_operations(uint8_t collection, store_t* store, bool& has_non_callable_transactions)
 {
     collection_info& info = _collections[collection];
     std::vector<transaction_info*> transactions;
-    std::set<uint64_t> ids;
 
     has_non_callable_transactions = false;
     bool has_callable_transactions = false;
 
-    uint64_t id = info.first_id;
-    for (; id != info.current_id; ++id)
+    // Superseded entries might have been truncated before being reached
+    info.next = std::max(info.next, info.log.first());
+
+    // Operations already sent are still pending, wait for them to keep the order
+    if (info.log.first() != info.next)
     {
-        auto& transaction = info.transactions[id];
+        return transactions;
+    }
 
-        // This transaction has been sent and is still pending
-        if (transaction.pending)
-        {
-            break;
-        }
+    uint64_t id = info.next;
+    for (; id != info.log.end(); ++id)
+    {
+        auto& transaction = *info.log.get(id);
 
-        if (transaction.done)
+        // Superseded by a later write
+        if (transaction.done())
         {
-            // TODO(gpascualg): Log why should this case happen at all
             continue;
         }
 
-        if (transaction.dependency)
+        if (auto dependency = std::get_if<struct dependency>(&transaction.payload))
         {
-            auto dependency = *transaction.dependency;
-            if (auto other = store->get_derived_or_null(dependency.owner))
+            if (auto other = store->get_derived_or_null(dependency->owner))
             {
-                if (auto info = other->get_transaction(collection, dependency.id))
+                // Truncated entries are done, so only existing ones can block
+                if (auto info = other->get_transaction(collection, dependency->id); info && !info->done())
                 {
-                    if (!info->done)
-                    {
-                        // Stop here if there is a dependency that has not yet completed
-                        break;
-                    }
+                    // Stop here if there is a dependency that has not yet completed
+                    break;
                 }
             }
 
             // Otherwise, the dependency is met, contiune with the next transaction
+            transaction.mark_done();
             continue;
         }
 
         // Callable transactions can only be executed if there is no pending operation
-        if (transaction.callable.has_value())
+        if (std::holds_alternative<callable_t>(transaction.payload))
         {
             if (has_non_callable_transactions)
             {
@@ -243,11 +246,11 @@ std::vector<transaction::transaction_info*> transaction::get_pending_operations(
             has_non_callable_transactions = true;
         }
 
-        transaction.pending = true;
+        transaction.state.store(operation_state::pending, std::memory_order_relaxed);
         transactions.push_back(&transaction);
     }
 
-    info.first_id = id;
+    info.next = id;
     return transactions;
 }
 
@@ -255,12 +258,18 @@ transaction::transaction_info* transaction::get_transaction(uint8_t collection,
 {
     if (auto at = _collections.find(collection); at != _collections.end())
     {
-        auto& info = at->second;
-        if (auto it = info.transactions.find(id); it != info.transactions.end())
-        {
-            return &it->second;
-        }
+        return at->second.log.get(resolve(at->second, id));
     }
 
     return nullptr;
 }
+
+uint64_t transaction::resolve(const collection_info& info, uint64_t id)
+{
+    for (auto it = info.superseded_by.find(id); it != info.superseded_by.end(); it = info.superseded_by.find(id))
+    {
+        id = it->second;
+    }
+
+    return id;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "containers/ring_log.hpp"
+#include "database/document_cache.hpp"
 #include "entity/entity.hpp"
 
 #include <boost/circular_buffer.hpp>
@@ -8,39 +10,96 @@
 #include <tao/tuple/tuple.hpp>
 
 #include <atomic>
-#include <optional>
-#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
 
 
 template <typename T, typename B> class static_store;
 class async_executor_base;
+class persistence_backend;
+class write_coalescer;
+
+
+// What a write overwrites, a later write with the same key supersedes a queued one
+struct fold_key
+{
+    fold_key(uint64_t document, std::string_view field);
+
+    bool operator==(const fold_key& other) const = default;
+
+    uint64_t document;
+    std::string field;
+};
+
+struct fold_key_hash
+{
+    inline std::size_t operator()(const fold_key& key) const noexcept
+    {
+        return static_cast<std::size_t>(key.document * 0x9E3779B97F4A7C15ull) ^ std::hash<std::string>{}(key.field);
+    }
+};
+
 
 class transaction : public entity<transaction>
 {
-    using callable_t = fu2::unique_function<void(mongocxx::collection)>;
+    friend class write_coalescer;
+
+    using callable_t = fu2::unique_function<void(persistence_backend*)>;
+
+    struct dependency
+    {
+        uint64_t owner;
+        uint64_t id;
+    };
+
+    enum class operation_state : uint8_t
+    {
+        queued      = 0,
+        pending     = 1,
+        done        = 2
+    };
 
     struct transaction_info
     {
-        struct dependency
-        {
-            uint64_t owner;
-            uint64_t id;
-        };
-
-        std::optional<struct dependency> dependency;
-        std::optional<mongocxx::model::write> operation;
-        std::optional<callable_t> callable;
-        bool pending;
-        bool done;
+        template <typename P>
+        transaction_info(P&& payload) :
+            payload(std::forward<P>(payload)),
+            state(operation_state::queued),
+            cached()
+        {}
+
+        transaction_info(mongocxx::model::write&& operation, const document_cache::pending_write& cached) :
+            payload(std::move(operation)),
+            state(operation_state::queued),
+            cached(cached)
+        {}
+
+        // Completion is flagged from the database threads
+        inline bool done() const { return state.load(std::memory_order_acquire) == operation_state::done; }
+        inline void mark_done() { state.store(operation_state::done, std::memory_order_release); }
+
+        std::variant<struct dependency, mongocxx::model::write, callable_t> payload;
+        std::atomic<operation_state> state;
+
+        // Writes are pending on the cache until the database executes them
+        document_cache::pending_write cached;
     };
 
     struct collection_info
     {
         collection_info();
 
-        uint64_t first_id;
-        std::atomic<uint64_t> current_id;
-        std::unordered_map<uint64_t, transaction_info> transactions;
+        // Entries before `next` have been sent, those before `log.first()` are done
+        uint64_t next;
+        ring_log<transaction_info> log;
+
+        // Last queued write of each key, cleared on dependencies and callables
+        std::unordered_map<fold_key, uint64_t, fold_key_hash> latest;
+
+        // Folded entries and the write that superseded them, others might depend on them
+        std::unordered_map<uint64_t, uint64_t> superseded_by;
     };
 
 public:
@@ -62,9 +121,13 @@ public:
     }
 
     void construct(uint64_t execute_every);
-    void update(uint64_t diff, store_t* store, async_executor_base* async);
+    void update(uint64_t diff, store_t* store, async_executor_base* async, write_coalescer* coalescer);
+    void sync();
 
     uint64_t push_operation(uint8_t collection, mongocxx::model::write&& operation);
+
+    // Same as above, but drops any write with the same key which has not been sent yet
+    uint64_t push_operation(uint8_t collection, const fold_key& key, mongocxx::model::write&& operation);
     uint64_t push_callable(uint8_t collection, callable_t&& callable);
     void push_dependency(uint8_t collection, uint64_t owner, uint64_t id);
 
@@ -75,6 +138,9 @@ private:
     std::vector<transaction_info*> get_pending_operations(uint8_t collection, store_t* store, bool& has_non_callable_transactions);
     transaction_info* get_transaction(uint8_t collection, uint64_t id);
 
+    // Follows folded entries to the write which superseded them
+    static uint64_t resolve(const collection_info& info, uint64_t id);
+
 private:
     std::unordered_map<uint8_t, collection_info> _collections;
     uint64_t _execute_every;
@@ -0,0 +1,83 @@
+#include "database/write_coalescer.hpp"
+#include "database/database.hpp"
+#include "async/async_executor.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+
+write_coalescer::write_coalescer(uint32_t max_batch_size) :
+    _max_batch_size(max_batch_size),
+    _buffers()
+{}
+
+void write_coalescer::push(uint8_t collection, std::vector<transaction::transaction_info*>&& transactions)
+{
+    get_buffer().push_back({ .collection = collection, .transactions = std::move(transactions) });
+}
+
+void write_coalescer::flush(async_executor_base* async, persistence_backend* backend)
+{
+    std::unordered_map<uint8_t, std::vector<transaction::transaction_info*>> batches;
+
+    for (uint16_t i = 0, count = std::min<uint16_t>(get_count(), MaxWorkerThreads); i < count; ++i)
+    {
+        for (auto& pending : _buffers[i])
+        {
+            auto& batch = batches[pending.collection];
+
+            // Operations of a single transaction are never split, bulk writes might execute
+            //  concurrently and they must keep their order
+            if (!batch.empty() && batch.size() + pending.transactions.size() > _max_batch_size)
+            {
+                submit(async, backend, pending.collection, std::move(batch));
+                batch = {};
+            }
+
+            batch.insert(batch.end(), pending.transactions.begin(), pending.transactions.end());
+        }
+
+        _buffers[i].clear();
+    }
+
+    for (auto& [collection, batch] : batches)
+    {
+        if (!batch.empty())
+        {
+            submit(async, backend, collection, std::move(batch));
+        }
+    }
+}
+
+void write_coalescer::submit(async_executor_base* async, persistence_backend* backend, uint8_t collection, std::vector<transaction::transaction_info*>&& batch)
+{
+    async->submit([backend, collection, transactions = std::move(batch)]()
+    {
+        std::vector<mongocxx::model::write> operations;
+        operations.reserve(transactions.size());
+
+        for (auto t : transactions)
+        {
+            operations.push_back(std::move(std::get<mongocxx::model::write>(t->payload)));
+        }
+
+        // Send transactions
+        backend->bulk_write(collection, std::move(operations));
+
+        // Once we get here, they are all executed, so flag them back on each transaction
+        auto cache = database::instance->cache();
+        for (auto t : transactions)
+        {
+            cache->acknowledge(t->cached);
+            t->mark_done();
+        }
+    });
+}
+
+inline std::vector<write_coalescer::pending_writes>& write_coalescer::get_buffer()
+{
+    thread_local uint16_t index = get_count()++;
+    assert(index < MaxWorkerThreads && "Too many threads pushing writes");
+    return _buffers[index];
+}
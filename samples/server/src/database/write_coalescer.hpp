@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/definitions.hpp"
+#include "database/transaction.hpp"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+
+class async_executor_base;
+class persistence_backend;
+
+
+// Gathers the write operations all transactions flush during a tick and sends them as
+//  a few size capped bulk writes per collection, instead of one per transaction
+class write_coalescer
+{
+    struct pending_writes
+    {
+        uint8_t collection;
+        std::vector<transaction::transaction_info*> transactions;
+    };
+
+public:
+    write_coalescer(uint32_t max_batch_size);
+
+    // Safe from any worker thread, all `transactions` must be write operations, in order
+    void push(uint8_t collection, std::vector<transaction::transaction_info*>&& transactions);
+
+    // Must not be called concurrently with `push`
+    void flush(async_executor_base* async, persistence_backend* backend);
+
+private:
+    void submit(async_executor_base* async, persistence_backend* backend, uint8_t collection, std::vector<transaction::transaction_info*>&& batch);
+
+    inline std::vector<pending_writes>& get_buffer();
+
+    inline std::atomic<uint16_t>& get_count()
+    {
+        static std::atomic<uint16_t> current = 0;
+        return current;
+    }
+
+private:
+    uint32_t _max_batch_size;
+    std::array<std::vector<pending_writes>, MaxWorkerThreads> _buffers;
+};
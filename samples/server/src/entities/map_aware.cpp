@@ -24,13 +24,13 @@ void map_aware::destroy()
     auto transaction = get<class transaction>();
     auto position = transform->position(server::instance->now());
 
-    transaction->push_operation(static_cast<uint8_t>(database_collections::characters), mongocxx::model::update_one(
+    transaction->push_operation(static_cast<uint8_t>(database_collections::characters), fold_key(_db_id, "position"), mongocxx::model::update_one(
         make_document(kvp("_id", _db_id)),
-        make_document(kvp("position", make_document(
+        make_document(kvp("$set", make_document(kvp("position", make_document(
             kvp("map", static_cast<int64_t>(transform->current_region()->get_map()->id())),
             kvp("x", position.x),
             kvp("y", position.y),
             kvp("z", position.z)
-        )))
+        )))))
     ));
 }
@@ -10,6 +10,7 @@ transform::transform() :
     _buffer(16),
     _current_region(nullptr),
     _current_cell(nullptr),
+    _cell_index(0),
     _is_moving(false)
 {}
 
@@ -21,44 +22,6 @@ void transform::construct(map* map, region* region, cell* cell)
     _current_cell = cell;
 }
 
-void transform::update(const base_time& diff, map* map)
-{
-    assert(_is_moving && "Only moving transforms need updates");
-    
-    auto position = this->position(server::instance->now());
-        
-    auto region_offset = _current_region->offset();
-    auto new_region_offset = region::offset_t::of(position.x, position.z);
-
-    // TODO(gpascualg): Maybe scheduling this inside the region in vectors would be much more data-friendly
-    //  Schedule to own region, execute durin sync pass in maps
-
-    if (region_offset != new_region_offset)
-    {
-        executor_registry::current()->schedule_if([this, map, new_region_offset](auto transform)
-        {
-            // Move entity to the new region
-            auto new_region = map->get_or_create_region(new_region_offset);
-            _current_region->move_to(new_region, get<map_aware>(), transform);
-            _current_region = new_region;
-        }, ticket());
-    }
-
-    auto cell_offset = _current_cell->offset();
-    auto new_cell_offset = cell::offset_t::of(position.x, position.y);
-
-    if (cell_offset != new_cell_offset)
-    {
-        executor_registry::current()->schedule_if([this, map, new_cell_offset, position](auto transform)
-        {
-            // Move entity to the new cell
-            auto new_cell = map->get_or_create_cell(new_cell_offset);
-            _current_cell->move_to(new_cell, transform, position);
-            _current_cell = new_cell;
-        }, ticket());
-    }
-}
-
 void transform::push(const time_point_t& timestamp, const glm::vec3& position, const glm::vec3& forward, float speed)
 {
     _buffer.push_back({
@@ -67,4 +30,6 @@ void transform::push(const time_point_t& timestamp, const glm::vec3& position, c
         .forward = forward,
         .speed = speed
     });
+
+    mark_changed();
 }
@@ -3,6 +3,7 @@
 #include "common/types.hpp"
 #include "common/definitions.hpp"
 
+#include <entity/change_tracked.hpp>
 #include <entity/entity.hpp>
 
 #include <boost/circular_buffer.hpp>
@@ -15,8 +16,11 @@ class region;
 
 struct moving_flag_t {};
 
-class transform : public entity<transform>
+class transform : public entity<transform>, public change_tracked
 {
+    friend class cell;
+    friend class map;
+
     struct physics
     {
         time_point_t timestamp;
@@ -29,7 +33,6 @@ public:
     transform();
 
     void construct(map* map, region* region, cell* cell);
-    void update(const base_time& diff, map* map);
 
     void push(const time_point_t& timestamp, const glm::vec3& position, const glm::vec3& forward, float speed);
 
@@ -43,6 +46,7 @@ private:
     boost::circular_buffer<physics> _buffer;
     region* _current_region;
     cell* _current_cell;
+    uint32_t _cell_index;
     bool _is_moving;
 };
 
@@ -6,6 +6,7 @@
 
 #include <glm/gtx/string_cast.hpp>
 
+#include <cstring>
 #include <iostream>
 
 
@@ -14,8 +15,22 @@ using bsoncxx::builder::basic::make_array;
 using bsoncxx::builder::basic::kvp;
 
 
-int main()
+int main(int argc, char** argv)
 {
+    network_mode mode = network_mode::asio;
+    bool reuse_port = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--batched") == 0)
+        {
+            mode = network_mode::batched;
+        }
+        else if (std::strcmp(argv[i], "--reuse-port") == 0)
+        {
+            reuse_port = true;
+        }
+    }
+
     database::initialize(mongocxx::uri("mongodb://localhost"), "umi", { 
         { static_cast<uint8_t>(database_collections::accounts), "accounts" },
         { static_cast<uint8_t>(database_collections::characters), "characters" }
@@ -30,7 +45,7 @@ int main()
         )))
     );
 
-    server server(7575, 3, 2);
+    server server(7575, 3, 2, mode, reuse_port);
     server.mainloop();
     server.stop();
     return 0;
@@ -1,24 +1,41 @@
 #include "core/server.hpp"
 #include "maps/cell.hpp"
+#include "maps/map.hpp"
 #include "entities/transform.hpp"
 
 
 cell::cell(map* map, const offset_t& offset) :
     _map(map),
-    _offset(offset)
+    _offset(offset),
+    _neighbours(),
+    _transforms(),
+    _positions(),
+    _subscribers(),
+    _pending()
 {}
 
-void entity_spawn(transform* transform, const glm::vec3& position)
+void cell::entity_spawn(transform* transform, const glm::vec3& position)
 {
+    add_transform(transform, position);
+    subscribe(transform);
+
     // This always happens sync
-    kumo::broadcast_spawned_entity(transform->current_cell(), { .id = transform->id(), .x = position.x, .z = position.z });
+    kumo::broadcast_spawned_entity(this, { .id = transform->id(), .x = position.x, .z = position.z });
+}
+
+void cell::entity_despawn(transform* transform)
+{
+    remove_transform(transform);
+    unsubscribe(transform);
+
+    kumo::broadcast_despawned_entity(this, { .id = transform->id() });
 }
 
-void cell::move_to(cell* other, transform* transform, const glm::vec3& position)
+void cell::announce_move(cell* other, transform* transform, const glm::vec3& position)
 {
-    auto ticket = transform->ticket();
-    _transforms.erase(std::find(_transforms.begin(), _transforms.end(), ticket)); // TODO(gpascualg): Optimize erase with a move
-    other->_transforms.push_back(ticket);
+    // Only one client lookup per cell change, broadcasts use the subscribers list
+    unsubscribe(transform);
+    other->subscribe(transform);
 
     // Send despawns and spawns
     const int8_t dx = static_cast<int8_t>(other->offset().x() - offset().x());
@@ -26,7 +43,7 @@ void cell::move_to(cell* other, transform* transform, const glm::vec3& position)
 
     for (auto& offset : new_offsets_in_direction(other->offset(), dx, dy))
     {
-        if (auto dest = _map->get_cell(offset))
+        if (auto dest = other->neighbour_at(offset))
         {
             kumo::broadcast_spawned_entity_single(dest, { .id = transform->id(), .x = position.x, .z = position.z });
         }
@@ -34,14 +51,124 @@ void cell::move_to(cell* other, transform* transform, const glm::vec3& position)
 
     for (auto& offset : new_offsets_in_direction(offset(), -dx, -dy))
     {
-        if (auto dest = _map->get_cell(offset); dest)
+        if (auto dest = neighbour_at(offset))
         {
             kumo::broadcast_despawned_entity_single(dest, { .id = transform->id() });
         }
     }
 }
 
+void cell::flush_broadcasts()
+{
+    auto deliver = [this](const std::vector<typename ticket<entity<client>>::ptr>& subscribers, bool from_neighbour) {
+        for (auto& ticket : subscribers)
+        {
+            if (!ticket->valid())
+            {
+                continue;
+            }
+
+            // All messages of the tick go to a subscriber at once
+            auto super_packet = ticket->get()->derived()->super_packet();
+            for (auto& pending : _pending)
+            {
+                if (!from_neighbour || pending.neighbours)
+                {
+                    pending.callback(super_packet);
+                }
+            }
+        }
+    };
+
+    deliver(_subscribers, false);
+    for (auto neighbour : _neighbours)
+    {
+        if (neighbour)
+        {
+            deliver(neighbour->_subscribers, true);
+        }
+    }
+
+    _pending.clear();
+}
+
+void cell::refresh_positions(const time_point_t& now)
+{
+    for (uint32_t i = 0, size = static_cast<uint32_t>(_transforms.size()); i < size; ++i)
+    {
+        const auto position = transform_at(i)->position(now);
+        _positions[i] = { position.x, position.z };
+    }
+}
+
 client* cell::get_client(transform* transform)
 {
     return server::instance->get_client(transform->id());
 }
+
+cell* cell::neighbour_at(const offset_t& offset) const
+{
+    for (auto neighbour : _neighbours)
+    {
+        if (neighbour && neighbour->offset() == offset)
+        {
+            return neighbour;
+        }
+    }
+
+    return nullptr;
+}
+
+void cell::subscribe(transform* transform)
+{
+    if (auto client = get_client(transform))
+    {
+        _subscribers.push_back(client->ticket());
+    }
+}
+
+void cell::unsubscribe(transform* transform)
+{
+    if (auto client = get_client(transform))
+    {
+        if (auto it = std::find(_subscribers.begin(), _subscribers.end(), client->ticket()); it != _subscribers.end())
+        {
+            *it = std::move(_subscribers.back());
+            _subscribers.pop_back();
+        }
+    }
+}
+
+void cell::queue_broadcast(pending_broadcast&& broadcast)
+{
+    if (_pending.empty())
+    {
+        _map->mark_broadcasting(this);
+    }
+
+    _pending.push_back(std::move(broadcast));
+}
+
+void cell::add_transform(transform* transform, const glm::vec3& position)
+{
+    transform->_cell_index = static_cast<uint32_t>(_transforms.size());
+    _transforms.push_back(transform->ticket());
+    _positions.push_back({ position.x, position.z });
+}
+
+void cell::remove_transform(transform* transform)
+{
+    const uint32_t index = transform->_cell_index;
+    assert(transform_at(index) == transform && "Transform is not in this cell");
+
+    // Swap with the last one and pop, patching its index
+    if (index + 1 != _transforms.size())
+    {
+        _transforms[index] = std::move(_transforms.back());
+        _positions[index] = _positions.back();
+        transform_at(index)->_cell_index = index;
+    }
+
+    _transforms.pop_back();
+    _positions.pop_back();
+}
@@ -3,44 +3,83 @@
 #include <containers/ticket.hpp>
 #include <entity/entity.hpp>
 
+#include "common/definitions.hpp"
 #include "core/client.hpp"
 #include "maps/offset.hpp"
 
+#include <function2/function2.hpp>
+#include <glm/glm.hpp>
 #include <kaminari/broadcaster.hpp>
 
+#include <array>
+#include <vector>
+
 
 class map;
 class transform;
 
 
+// Area of interest unit, clients in a cell receive broadcasts from it and its neighbours
 class cell : public kaminari::broadcaster<cell>
 {
     friend class map;
 
+    using super_packet_t = std::remove_pointer_t<decltype(std::declval<client&>().super_packet())>;
+
+    struct pending_broadcast
+    {
+        fu2::unique_function<void(super_packet_t*)> callback;
+        bool neighbours;
+    };
+
 public:
     using offset_t = offset<float, 15>;
 
     cell(map* map, const offset_t& offset);
 
     inline const offset_t& offset() const;
+    inline cell* neighbour(uint8_t direction) const;
+
+    // Positions in the (x, z) plane as of the last sync, in the same order as transforms
+    inline const std::vector<glm::vec2>& positions() const;
+    inline transform* transform_at(uint32_t index) const;
 
     void entity_spawn(transform* transform, const glm::vec3& position);
-    void move_to(cell* other, transform* transform, const glm::vec3& position);
+    void entity_despawn(transform* transform);
 
+    // Membership is changed by the map in batches, this only updates subscriptions and
+    //  sends spawns/despawns to the cells that start/stop seeing the transform
+    void announce_move(cell* other, transform* transform, const glm::vec3& position);
+
+    // Broadcasts are queued and fanned out once per tick, on the map sync
     template <typename C>
     void broadcast(C&& callback);
 
     template <typename C>
     void broadcast_single(C&& callback);
 
+    void flush_broadcasts();
+    void refresh_positions(const time_point_t& now);
+
 private:
     // TODO(gpascualg): Auxiliary method to get client without including server.hpp here in a .hpp
     client* get_client(transform* transform);
 
+    cell* neighbour_at(const offset_t& offset) const;
+    void subscribe(transform* transform);
+    void unsubscribe(transform* transform);
+    void queue_broadcast(pending_broadcast&& broadcast);
+    void add_transform(transform* transform, const glm::vec3& position);
+    void remove_transform(transform* transform);
+
 private:
     map* _map;
     offset_t _offset;
+    std::array<cell*, cell_information::num_neighbors> _neighbours;
     std::vector<typename ticket<entity<transform>>::ptr> _transforms;
+    std::vector<glm::vec2> _positions;
+    std::vector<typename ticket<entity<client>>::ptr> _subscribers;
+    std::vector<pending_broadcast> _pending;
 };
 
 
@@ -49,32 +88,29 @@ inline const cell::offset_t& cell::offset() const
     return _offset;
 }
 
+inline cell* cell::neighbour(uint8_t direction) const
+{
+    return _neighbours[direction];
+}
+
+inline const std::vector<glm::vec2>& cell::positions() const
+{
+    return _positions;
+}
+
+inline transform* cell::transform_at(uint32_t index) const
+{
+    return _transforms[index]->get<transform>();
+}
+
 template <typename C>
 void cell::broadcast(C&& callback)
 {
-    broadcast_single(callback);
-
-    for (auto offset : neighbours_of(_offset))
-    {
-        // HACK(gpascualg): This template uses an incomplete map* type
-        if (auto cell = _map->get_cell(offset))
-        {
-            broadcast_single(callback);
-        }
-    }
+    queue_broadcast({ .callback = std::forward<C>(callback), .neighbours = true });
 }
 
 template <typename C>
 void cell::broadcast_single(C&& callback)
 {
-    for (auto& ticket : _transforms)
-    {
-        if (auto transform = ticket->get()->derived())
-        {
-            if (auto client = get_client(transform))
-            {
-                callback(client->super_packet());
-            }
-        }
-    }
+    queue_broadcast({ .callback = std::forward<C>(callback), .neighbours = false });
 }
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "maps/offset.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+
+// Sparse hex grid indexed by axial coordinates. Objects are stored inline in square
+//  chunks of `ChunkSide` x `ChunkSide` cells, which are allocated on demand and never
+//  move, so pointers to objects stay valid until `clear`
+template <typename T, typename O, uint32_t ChunkSide>
+class hex_grid
+{
+    static_assert((ChunkSide & (ChunkSide - 1)) == 0, "Chunk side must be a power of two");
+
+    static constexpr int32_t chunk_shift = std::countr_zero(ChunkSide);
+    static constexpr int32_t chunk_mask = ChunkSide - 1;
+
+    struct chunk
+    {
+        std::array<std::optional<T>, ChunkSide * ChunkSide> objects;
+    };
+
+    struct chunk_slot
+    {
+        typename O::hash_t key;
+        chunk* ptr;
+    };
+
+    // Cyclic order, used to walk rings
+    static constexpr std::array<std::pair<int32_t, int32_t>, 6> ring_directions = {{
+        { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, 0 }, { -1, 1 }, { 0, 1 }
+    }};
+
+public:
+    hex_grid() noexcept;
+
+    inline T* get(const O& offset) const noexcept;
+
+    // Returns the object and whether it has just been created
+    template <typename... Args>
+    std::pair<T*, bool> get_or_emplace(const O& offset, Args&&... args) noexcept;
+
+    // Existing objects exactly `radius` cells away from `center`
+    template <typename C>
+    void ring(const O& center, int32_t radius, C&& callback) const noexcept;
+
+    // Existing objects up to `radius` cells away from `center`, center included
+    template <typename C>
+    void disk(const O& center, int32_t radius, C&& callback) const noexcept;
+
+    template <typename C>
+    void each(C&& callback) noexcept;
+
+    void clear() noexcept;
+    inline std::size_t size() const noexcept;
+
+private:
+    inline chunk* find_chunk(int32_t cx, int32_t cy) const noexcept;
+    chunk* get_or_create_chunk(int32_t cx, int32_t cy) noexcept;
+    void grow_table() noexcept;
+
+    static inline std::size_t index_of(int32_t x, int32_t y) noexcept;
+    static inline std::size_t slot_of(typename O::hash_t key, std::size_t mask) noexcept;
+
+private:
+    std::vector<std::unique_ptr<chunk>> _chunks;
+    std::vector<chunk_slot> _table;
+    std::size_t _size;
+};
+
+
+template <typename T, typename O, uint32_t ChunkSide>
+hex_grid<T, O, ChunkSide>::hex_grid() noexcept :
+    _chunks(),
+    _table(16, chunk_slot { .key = 0, .ptr = nullptr }),
+    _size(0)
+{}
+
+template <typename T, typename O, uint32_t ChunkSide>
+inline T* hex_grid<T, O, ChunkSide>::get(const O& offset) const noexcept
+{
+    if (auto chunk = find_chunk(offset.x() >> chunk_shift, offset.y() >> chunk_shift))
+    {
+        if (auto& object = chunk->objects[index_of(offset.x(), offset.y())])
+        {
+            return &*object;
+        }
+    }
+
+    return nullptr;
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+template <typename... Args>
+std::pair<T*, bool> hex_grid<T, O, ChunkSide>::get_or_emplace(const O& offset, Args&&... args) noexcept
+{
+    auto chunk = get_or_create_chunk(offset.x() >> chunk_shift, offset.y() >> chunk_shift);
+    auto& object = chunk->objects[index_of(offset.x(), offset.y())];
+    if (object)
+    {
+        return { &*object, false };
+    }
+
+    object.emplace(std::forward<Args>(args)...);
+    ++_size;
+    return { &*object, true };
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+template <typename C>
+void hex_grid<T, O, ChunkSide>::ring(const O& center, int32_t radius, C&& callback) const noexcept
+{
+    if (radius == 0)
+    {
+        if (auto object = get(center))
+        {
+            callback(object);
+        }
+        return;
+    }
+
+    int32_t x = center.x() + ring_directions[4].first * radius;
+    int32_t y = center.y() + ring_directions[4].second * radius;
+
+    for (const auto& [dx, dy] : ring_directions)
+    {
+        for (int32_t step = 0; step < radius; ++step)
+        {
+            if (auto object = get(O(x, y)))
+            {
+                callback(object);
+            }
+
+            x += dx;
+            y += dy;
+        }
+    }
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+template <typename C>
+void hex_grid<T, O, ChunkSide>::disk(const O& center, int32_t radius, C&& callback) const noexcept
+{
+    for (int32_t r = 0; r <= radius; ++r)
+    {
+        ring(center, r, callback);
+    }
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+template <typename C>
+void hex_grid<T, O, ChunkSide>::each(C&& callback) noexcept
+{
+    for (auto& chunk : _chunks)
+    {
+        for (auto& object : chunk->objects)
+        {
+            if (object)
+            {
+                callback(&*object);
+            }
+        }
+    }
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+void hex_grid<T, O, ChunkSide>::clear() noexcept
+{
+    _chunks.clear();
+    std::fill(_table.begin(), _table.end(), chunk_slot { .key = 0, .ptr = nullptr });
+    _size = 0;
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+inline std::size_t hex_grid<T, O, ChunkSide>::size() const noexcept
+{
+    return _size;
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+inline typename hex_grid<T, O, ChunkSide>::chunk* hex_grid<T, O, ChunkSide>::find_chunk(int32_t cx, int32_t cy) const noexcept
+{
+    const auto key = O::hash(cx, cy);
+    const std::size_t mask = _table.size() - 1;
+
+    for (std::size_t idx = slot_of(key, mask); ; idx = (idx + 1) & mask)
+    {
+        const auto& slot = _table[idx];
+        if (!slot.ptr)
+        {
+            return nullptr;
+        }
+
+        if (slot.key == key)
+        {
+            return slot.ptr;
+        }
+    }
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+typename hex_grid<T, O, ChunkSide>::chunk* hex_grid<T, O, ChunkSide>::get_or_create_chunk(int32_t cx, int32_t cy) noexcept
+{
+    if (auto chunk = find_chunk(cx, cy))
+    {
+        return chunk;
+    }
+
+    // Keep the table at most half full
+    if ((_chunks.size() + 1) * 2 > _table.size())
+    {
+        grow_table();
+    }
+
+    auto chunk = _chunks.emplace_back(std::make_unique<hex_grid::chunk>()).get();
+
+    const auto key = O::hash(cx, cy);
+    const std::size_t mask = _table.size() - 1;
+    std::size_t idx = slot_of(key, mask);
+    while (_table[idx].ptr)
+    {
+        idx = (idx + 1) & mask;
+    }
+
+    _table[idx] = { .key = key, .ptr = chunk };
+    return chunk;
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+void hex_grid<T, O, ChunkSide>::grow_table() noexcept
+{
+    std::vector<chunk_slot> table(_table.size() * 2, chunk_slot { .key = 0, .ptr = nullptr });
+    const std::size_t mask = table.size() - 1;
+
+    for (const auto& slot : _table)
+    {
+        if (!slot.ptr)
+        {
+            continue;
+        }
+
+        std::size_t idx = slot_of(slot.key, mask);
+        while (table[idx].ptr)
+        {
+            idx = (idx + 1) & mask;
+        }
+
+        table[idx] = slot;
+    }
+
+    _table = std::move(table);
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+inline std::size_t hex_grid<T, O, ChunkSide>::index_of(int32_t x, int32_t y) noexcept
+{
+    return static_cast<std::size_t>(y & chunk_mask) * ChunkSide + static_cast<std::size_t>(x & chunk_mask);
+}
+
+template <typename T, typename O, uint32_t ChunkSide>
+inline std::size_t hex_grid<T, O, ChunkSide>::slot_of(typename O::hash_t key, std::size_t mask) noexcept
+{
+    // Offset hashes are just both coordinates packed, mix them before masking
+    return static_cast<std::size_t>(((key ^ (key >> 32)) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
@@ -1,81 +1,180 @@
 #include "core/server.hpp"
+#include "entities/transform.hpp"
 #include "maps/map.hpp"
-
-#include <updater/executor_registry.hpp>
+#include "maps/offset_batch.hpp"
 
 
 void map::construct()
 {
-    for (auto& [ofs, cell] : _cells)
-    {
-        delete cell;
-    }
     _cells.clear();
-
-    for (auto& [ofs, region] : _regions)
-    {
-        delete region;
-    }
     _regions.clear();
+
+    _broadcasting_cells.clear();
 }
 
 void map::update(const base_time& diff)
 {
-    // TODO(gpascualg): Can we make executors provide an easy way to do this?
-    // All regions are updated in parallel
-    boost::fibers::fiber([this, &diff]() mutable 
+    // Gather all regions into a single work list, chunks are balanced regardless of region sizes
+    _transforms_updater.clear();
+    _regions.each([this](region* region) {
+        _transforms_updater.push(&region->moving_transforms());
+    });
+
+    const auto now = server::instance->now();
+
+    boost::fibers::fiber([this, now]() mutable 
         {
-            // 1. Schedule update all
-            for (auto& [ofs, region] : _regions)
-            {
-                region->updater().update(std::ref(diff), this);
-            }
-
-            // 2. Schedule wait all
-            for (auto& [ofs, region] : _regions)
-            {
-                region->updater().wait_update();
-            }
+            // Positions are classified in batches, regions are write-locked while updating, so only
+            //  record moves of transforms changing cell or region and apply them during the map sync
+            _transforms_updater.update_chunks([this, now](auto it, auto end) {
+                const auto count = static_cast<std::size_t>(end - it);
+
+                frame_vector<glm::vec3> positions;
+                positions.reserve(count);
+                for (auto current = it; current != end; ++current)
+                {
+                    positions.push_back((*current)->position(now));
+                }
+
+                frame_vector<region::offset_t> region_offsets(count, region::offset_t(0, 0));
+                frame_vector<cell::offset_t> cell_offsets(count, cell::offset_t(0, 0));
+                offsets_of(positions, std::span(region_offsets));
+                offsets_of(positions, std::span(cell_offsets));
+
+                for (std::size_t i = 0; i < count; ++i, ++it)
+                {
+                    auto transform = *it;
+                    if (transform->current_region()->offset() != region_offsets[i] || transform->current_cell()->offset() != cell_offsets[i])
+                    {
+                        record_move(transform->id(), {
+                            .from = transform->current_region(),
+                            .region_offset = region_offsets[i],
+                            .cell_offset = cell_offsets[i],
+                            .position = positions[i]
+                        });
+                    }
+                }
+            });
+            _transforms_updater.wait_update();
         }).join();
 }
 
-region* map::get_region(const region::offset_t& offset) const
+void map::sync(const base_time& diff)
 {
-    if (auto it = _regions.find(offset.hash()); it != _regions.end())
+    // Cell membership changes are gathered while moving and applied together afterwards
+    frame_vector<cell_change> cell_changes;
+
+    // Apply all structural changes recorded during the update, sorted by entity
+    _transform_moves.playback([this, &cell_changes](structural_command type, uint64_t id, const transform_move& move) {
+        assert(type == structural_command::move && "Transforms only record moves");
+
+        // It might have been destroyed since the move was recorded
+        auto transform = move.from->moving_transform(id);
+        if (!transform)
+        {
+            return;
+        }
+
+        // Cells hold tickets, which follow the transform when it changes region
+        if (transform->_current_cell->offset() != move.cell_offset)
+        {
+            auto new_cell = get_or_create_cell(move.cell_offset);
+            cell_changes.push_back({
+                .moved = transform->ticket(),
+                .from = transform->_current_cell,
+                .to = new_cell,
+                .position = move.position
+            });
+            transform->_current_cell = new_cell;
+        }
+
+        if (move.from->offset() != move.region_offset)
+        {
+            auto new_region = get_or_create_region(move.region_offset);
+            transform = move.from->move_to(new_region, transform);
+            transform->_current_region = new_region;
+        }
+    });
+
+    // All removals first, then all insertions, each one is a swap/push on contiguous arrays
+    for (const auto& change : cell_changes)
     {
-        return it->second;
+        change.from->remove_transform(change.moved->get<transform>());
     }
 
-    return nullptr;
-}
+    for (const auto& change : cell_changes)
+    {
+        change.to->add_transform(change.moved->get<transform>(), change.position);
+    }
 
-cell* map::get_cell(const cell::offset_t& offset) const
-{
-    if (auto it = _cells.find(offset.hash()); it != _cells.end())
+    for (const auto& change : cell_changes)
     {
-        return it->second;
+        change.from->announce_move(change.to, change.moved->get<transform>(), change.position);
     }
 
-    return nullptr;
+    // Snapshot positions for spatial queries
+    const auto now = server::instance->now();
+    _cells.each([&now](cell* cell) {
+        cell->refresh_positions(now);
+    });
+
+    // Fan out everything broadcasted this tick
+    for (auto cell : _broadcasting_cells)
+    {
+        cell->flush_broadcasts();
+    }
+    _broadcasting_cells.clear();
 }
 
-region* map::get_or_create_region(const region::offset_t& offset)
+frame_vector<transform*> map::nearest(const glm::vec3& center, uint32_t k, float max_radius) const
 {
-    if (auto region = get_region(offset))
+    frame_vector<spatial::hit<cell>> hits;
+    hits.reserve(k);
+    spatial::nearest(_cells, { center.x, center.z }, k, max_radius, hits);
+
+    frame_vector<transform*> transforms;
+    transforms.reserve(hits.size());
+    for (const auto& hit : hits)
     {
-        return region;
+        transforms.push_back(hit.object->transform_at(hit.index));
     }
 
-    auto region = _regions.emplace(offset.hash(), new ::region(this, offset)).first->second;
-    return region;
+    return transforms;
+}
+
+region* map::get_region(const region::offset_t& offset) const
+{
+    return _regions.get(offset);
+}
+
+cell* map::get_cell(const cell::offset_t& offset) const
+{
+    return _cells.get(offset);
+}
+
+region* map::get_or_create_region(const region::offset_t& offset)
+{
+    return _regions.get_or_emplace(offset, this, offset).first;
 }
 
 cell* map::get_or_create_cell(const cell::offset_t& offset)
 {
-    if (auto cell = get_cell(offset))
+    auto [cell, created] = _cells.get_or_emplace(offset, this, offset);
+    if (!created)
     {
         return cell;
     }
 
-    return _cells.emplace(offset.hash(), new cell(this, offset)).first->second;
+    // Link both ways with any existing neighbour
+    auto neighbours = neighbours_of(offset);
+    for (uint8_t i = 0; i < cell_information::num_neighbors; ++i)
+    {
+        if (auto neighbour = get_cell(neighbours[i]))
+        {
+            cell->_neighbours[i] = neighbour;
+            neighbour->_neighbours[cell_information::Opposite[i]] = cell;
+        }
+    }
+
+    return cell;
 }
@@ -1,10 +1,34 @@
 #pragma once
 
 #include "maps/cell.hpp"
+#include "maps/hex_grid.hpp"
 #include "maps/region.hpp"
+#include "maps/spatial_query.hpp"
 
+#include <containers/command_buffer.hpp>
 #include <entity/entity.hpp>
+#include <pools/frame_allocator.hpp>
+#include <updater/updater_chunked.hpp>
 
+#include <thread>
+#include <vector>
+
+
+struct transform_move
+{
+    region* from;
+    region::offset_t region_offset;
+    cell::offset_t cell_offset;
+    glm::vec3 position;
+};
+
+struct cell_change
+{
+    ticket_of_t<transform> moved;
+    cell* from;
+    cell* to;
+    glm::vec3 position;
+};
 
 class map : public entity<map>
 {
@@ -13,6 +37,10 @@ public:
     void construct();
 
     void update(const base_time& diff);
+    void sync(const base_time& diff);
+
+    inline void record_move(uint64_t id, const transform_move& move);
+    inline void mark_broadcasting(cell* cell);
 
     region* get_region(const region::offset_t& offset) const;
     cell* get_cell(const cell::offset_t& offset) const;
@@ -23,15 +51,47 @@ public:
     template <typename C>
     void create_entity_at(uint64_t id, uint64_t db_id, const glm::vec3& position, C&& callback);
 
+    // Spatial queries see positions as of the last sync
+    template <typename C>
+    void query_radius(const glm::vec3& center, float radius, C&& callback) const;
+    frame_vector<transform*> nearest(const glm::vec3& center, uint32_t k, float max_radius) const;
+
 private:
-    std::unordered_map<typename cell::offset_t::hash_t, cell*> _cells;
-    std::unordered_map<typename region::offset_t::hash_t, region*> _regions;
+    // Regions are big objects, keep their chunks small
+    hex_grid<cell, cell::offset_t, 16> _cells;
+    hex_grid<region, region::offset_t, 2> _regions;
+
+    // Moving transforms of all regions are updated together, hubs and wilderness alike
+    updater_chunked<region::dic_t<transform>> _transforms_updater { std::thread::hardware_concurrency(), MapUpdateMinGrain };
+    command_buffer<transform_move, MaxWorkerThreads, frame_allocator<command<transform_move>>> _transform_moves;
+
+    // Cells with queued broadcasts, flushed on sync
+    std::vector<cell*> _broadcasting_cells;
 };
 
 
+inline void map::record_move(uint64_t id, const transform_move& move)
+{
+    _transform_moves.move(id, move);
+}
+
+inline void map::mark_broadcasting(cell* cell)
+{
+    _broadcasting_cells.push_back(cell);
+}
+
+
 template <typename C>
 void map::create_entity_at(uint64_t id, uint64_t db_id, const glm::vec3& position, C&& callback)
 {
     auto region = get_or_create_region(region::offset_t::of(position.x, position.z));
-    region->create_entity(this, get_or_create_cell(cell::offset_t::of(position.x, position.y)), id, db_id, position, std::move(callback));
+    region->create_entity(this, get_or_create_cell(cell::offset_t::of(position.x, position.z)), id, db_id, position, std::move(callback));
+}
+
+template <typename C>
+void map::query_radius(const glm::vec3& center, float radius, C&& callback) const
+{
+    spatial::query_radius(_cells, { center.x, center.z }, radius, [&callback](cell* cell, uint32_t index) {
+        callback(cell->transform_at(index));
+    });
 }
@@ -19,6 +19,9 @@ namespace cell_information
         {4, 0, 1},
         {5, -1, 1}
     };
+
+    // Index of the opposite direction, in the same order as `neighbours_of`
+    constexpr inline uint8_t Opposite[num_neighbors] = { 4, 5, 3, 2, 0, 1 };
 };
 
 template <typename CoordType, uint32_t Size>
@@ -90,7 +93,8 @@ public:
 
     constexpr static hash_t hash(int32_t x, int32_t y)
     {
-        return (cx::u64(y) << 32) | cx::u64(x);
+        // Negative coordinates must not sign-extend over the other one
+        return (cx::u64(static_cast<uint32_t>(y)) << 32) | cx::u64(static_cast<uint32_t>(x));
     }
 
     constexpr int32_t distance(const offset& offset) const
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "maps/offset.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cassert>
+#include <span>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+    #include <immintrin.h>
+#endif
+
+
+// Batched `offset::of` over the (x, z) plane of many positions at once
+//  Results are identical to the scalar version, vectorized with AVX2 or SSE4.1 when
+//  the target allows it (see ENABLE_NATIVE_ARCH)
+template <typename C, uint32_t S>
+void offsets_of(std::span<const glm::vec3> positions, std::span<offset<C, S>> offsets) noexcept;
+
+
+namespace detail
+{
+    constexpr inline float offset_r_factor = cx::sqrt(3.0f) / 3.0f;
+
+    // Round half away from zero, as `round` does, by truncating after adding the
+    //  largest float below 0.5
+    constexpr inline float offset_round_bias = 0.49999997f;
+
+#if defined(__AVX2__)
+    template <uint32_t S>
+    inline void offsets_of_avx2(const float* xs, const float* ys, int32_t* out_x, int32_t* out_y) noexcept
+    {
+        const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+        const __m256 bias = _mm256_set1_ps(offset_round_bias);
+        const __m256 size = _mm256_set1_ps(static_cast<float>(S));
+
+        auto round = [&](__m256 v) {
+            __m256 biased = _mm256_add_ps(v, _mm256_or_ps(bias, _mm256_and_ps(v, sign_mask)));
+            return _mm256_round_ps(biased, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        };
+
+        auto abs = [&](__m256 v) {
+            return _mm256_andnot_ps(sign_mask, v);
+        };
+
+        const __m256 fx = _mm256_loadu_ps(xs);
+        const __m256 fy = _mm256_loadu_ps(ys);
+
+        const __m256 q = _mm256_div_ps(_mm256_div_ps(_mm256_mul_ps(fx, _mm256_set1_ps(2.0f)), _mm256_set1_ps(3.0f)), size);
+        const __m256 r = _mm256_div_ps(
+            _mm256_add_ps(
+                _mm256_div_ps(_mm256_xor_ps(fx, sign_mask), _mm256_set1_ps(3.0f)),
+                _mm256_mul_ps(_mm256_set1_ps(offset_r_factor), fy)),
+            size);
+        const __m256 s = _mm256_sub_ps(_mm256_xor_ps(q, sign_mask), r);
+
+        const __m256 q_round = round(q);
+        const __m256 r_round = round(r);
+        const __m256 s_round = round(s);
+
+        const __m256 q_diff = abs(_mm256_sub_ps(q_round, q));
+        const __m256 r_diff = abs(_mm256_sub_ps(r_round, r));
+        const __m256 s_diff = abs(_mm256_sub_ps(s_round, s));
+
+        const __m256i q_int = _mm256_cvttps_epi32(q_round);
+        const __m256i r_int = _mm256_cvttps_epi32(r_round);
+        const __m256i s_int = _mm256_cvttps_epi32(s_round);
+
+        // Same branches as the scalar version, as masks
+        const __m256i fix_q = _mm256_castps_si256(_mm256_and_ps(_mm256_cmp_ps(q_diff, r_diff, _CMP_GT_OQ), _mm256_cmp_ps(q_diff, s_diff, _CMP_GT_OQ)));
+        const __m256i fix_r = _mm256_andnot_si256(fix_q, _mm256_castps_si256(_mm256_cmp_ps(r_diff, s_diff, _CMP_GT_OQ)));
+
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i x = _mm256_blendv_epi8(q_int, _mm256_sub_epi32(_mm256_sub_epi32(zero, r_int), s_int), fix_q);
+        const __m256i y = _mm256_blendv_epi8(r_int, _mm256_sub_epi32(_mm256_sub_epi32(zero, q_int), s_int), fix_r);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_x), x);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_y), y);
+    }
+#elif defined(__SSE4_1__)
+    template <uint32_t S>
+    inline void offsets_of_sse41(const float* xs, const float* ys, int32_t* out_x, int32_t* out_y) noexcept
+    {
+        const __m128 sign_mask = _mm_set1_ps(-0.0f);
+        const __m128 bias = _mm_set1_ps(offset_round_bias);
+        const __m128 size = _mm_set1_ps(static_cast<float>(S));
+
+        auto round = [&](__m128 v) {
+            __m128 biased = _mm_add_ps(v, _mm_or_ps(bias, _mm_and_ps(v, sign_mask)));
+            return _mm_round_ps(biased, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        };
+
+        auto abs = [&](__m128 v) {
+            return _mm_andnot_ps(sign_mask, v);
+        };
+
+        const __m128 fx = _mm_loadu_ps(xs);
+        const __m128 fy = _mm_loadu_ps(ys);
+
+        const __m128 q = _mm_div_ps(_mm_div_ps(_mm_mul_ps(fx, _mm_set1_ps(2.0f)), _mm_set1_ps(3.0f)), size);
+        const __m128 r = _mm_div_ps(
+            _mm_add_ps(
+                _mm_div_ps(_mm_xor_ps(fx, sign_mask), _mm_set1_ps(3.0f)),
+                _mm_mul_ps(_mm_set1_ps(offset_r_factor), fy)),
+            size);
+        const __m128 s = _mm_sub_ps(_mm_xor_ps(q, sign_mask), r);
+
+        const __m128 q_round = round(q);
+        const __m128 r_round = round(r);
+        const __m128 s_round = round(s);
+
+        const __m128 q_diff = abs(_mm_sub_ps(q_round, q));
+        const __m128 r_diff = abs(_mm_sub_ps(r_round, r));
+        const __m128 s_diff = abs(_mm_sub_ps(s_round, s));
+
+        const __m128i q_int = _mm_cvttps_epi32(q_round);
+        const __m128i r_int = _mm_cvttps_epi32(r_round);
+        const __m128i s_int = _mm_cvttps_epi32(s_round);
+
+        // Same branches as the scalar version, as masks
+        const __m128i fix_q = _mm_castps_si128(_mm_and_ps(_mm_cmpgt_ps(q_diff, r_diff), _mm_cmpgt_ps(q_diff, s_diff)));
+        const __m128i fix_r = _mm_andnot_si128(fix_q, _mm_castps_si128(_mm_cmpgt_ps(r_diff, s_diff)));
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i x = _mm_blendv_epi8(q_int, _mm_sub_epi32(_mm_sub_epi32(zero, r_int), s_int), fix_q);
+        const __m128i y = _mm_blendv_epi8(r_int, _mm_sub_epi32(_mm_sub_epi32(zero, q_int), s_int), fix_r);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out_x), x);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out_y), y);
+    }
+#endif
+}
+
+
+template <typename C, uint32_t S>
+void offsets_of(std::span<const glm::vec3> positions, std::span<offset<C, S>> offsets) noexcept
+{
+    assert(positions.size() <= offsets.size() && "Not enough room for all offsets");
+
+    std::size_t i = 0;
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+    #if defined(__AVX2__)
+        constexpr std::size_t lanes = 8;
+    #else
+        constexpr std::size_t lanes = 4;
+    #endif
+
+    // Positions are AoS, transpose each batch before converting
+    alignas(32) float xs[lanes];
+    alignas(32) float ys[lanes];
+    alignas(32) int32_t out_x[lanes];
+    alignas(32) int32_t out_y[lanes];
+
+    for (; i + lanes <= positions.size(); i += lanes)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            xs[lane] = positions[i + lane].x;
+            ys[lane] = positions[i + lane].z;
+        }
+
+    #if defined(__AVX2__)
+        detail::offsets_of_avx2<S>(xs, ys, out_x, out_y);
+    #else
+        detail::offsets_of_sse41<S>(xs, ys, out_x, out_y);
+    #endif
+
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            offsets[i + lane] = offset<C, S>(out_x[lane], out_y[lane]);
+        }
+    }
+#endif
+
+    // Tail, or everything if there is no vector support
+    for (; i < positions.size(); ++i)
+    {
+        offsets[i] = offset<C, S>::of(positions[i].x, positions[i].z);
+    }
+}
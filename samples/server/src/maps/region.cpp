@@ -8,18 +8,19 @@ region::region(map* map, const offset_t& offset) :
     _common_store(),
     _moving_store(),
     _map_aware_scheme(_common_store),
-    _moving_transforms_scheme(_moving_store),
-    _transforms_updater(tao::make_tuple(&_moving_transforms_scheme.get<transform>()))
+    _moving_transforms_scheme(_moving_store)
 {}
 
-void region::move_to(region* other, map_aware* who, transform* trf)
+transform* region::move_to(region* other, transform* trf)
 {
     // If it is moving, it means it's on the moving scheme
-    _moving_transforms_scheme.move(other->_moving_transforms_scheme, who, trf);
+    return _moving_transforms_scheme.move(other->_moving_transforms_scheme, trf).get<transform>();
 }
 
 void region::remove_entity(transform* transform)
 {
+    transform->current_cell()->entity_despawn(transform);
+
     if (transform->is_moving())
     {
         _moving_transforms_scheme.free(transform->get<map_aware>());
@@ -36,6 +37,7 @@ void region::on_entity_created(map_aware* map_aware, transform* transform, const
 {
     // Push initial position
     transform->push(server::instance->now(), position, glm::vec3{ 1, 0, 0 }, 0.0);
+    transform->current_cell()->entity_spawn(transform, position);
 
     // Create transactional object and push it to the entity (so that we can do transform->get<transaction>())
     auto transaction = server::instance->create_entity_transaction(map_aware->db_id());
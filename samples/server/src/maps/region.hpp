@@ -27,12 +27,14 @@ public:
     // TODO(gpascualg): I don't like this name (can use map, but then I'd have to class map everything else)
     inline map* get_map() const;
     inline const offset_t& offset() const;
-    inline updater_contiguous<region::dic_t<transform>*>& updater();
+    inline dic_t<transform>& moving_transforms();
 
     template <typename C>
     void create_entity(map* map, cell* cell, uint64_t id, uint64_t db_id, const glm::vec3& position, C&& callback);
     void remove_entity(transform* transform);
-    void move_to(region* other, map_aware* who, transform* trf);
+    transform* move_to(region* other, transform* trf);
+
+    inline transform* moving_transform(uint64_t id) const;
 
 private:
     void on_entity_created(map_aware* map_aware, transform* transform, const glm::vec3& position);
@@ -46,8 +48,6 @@ private:
 
     decltype(scheme_maker<map_aware, transform>()(_common_store)) _map_aware_scheme;
     decltype(scheme_maker<map_aware, transform>()(_moving_store)) _moving_transforms_scheme;
-
-    updater_contiguous<region::dic_t<transform>*> _transforms_updater;
 };
 
 
@@ -61,9 +61,14 @@ inline const region::offset_t& region::offset() const
     return _offset;
 }
 
-inline updater_contiguous<region::dic_t<transform>*>& region::updater()
+inline region::dic_t<transform>& region::moving_transforms()
+{
+    return _moving_transforms_scheme.get<transform>();
+}
+
+inline transform* region::moving_transform(uint64_t id) const
 {
-    return _transforms_updater;
+    return _moving_transforms_scheme.get<transform>(id);
 }
 
 template <typename C>
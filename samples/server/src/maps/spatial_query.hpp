@@ -0,0 +1,130 @@
+#pragma once
+
+#include "maps/hex_grid.hpp"
+#include "maps/offset.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+// Radius and k-nearest queries over a hex grid whose objects expose `positions()`, a
+//  contiguous array of (x, z) positions. Callbacks receive the object and the index of
+//  the matching position in it
+namespace spatial
+{
+    template <typename T>
+    struct hit
+    {
+        T* object;
+        uint32_t index;
+        float distance_sq;
+    };
+
+    // Lower bound of the distance from any point in a cell to any point `ring` cells away
+    //  Cell centers that far are at least 1.5 * ring * size apart, and points are at most
+    //  `size` away from their cell center
+    template <typename O>
+    constexpr float ring_min_distance(int32_t ring) noexcept;
+
+    // Farthest ring that can hold a point within `radius`
+    template <typename O>
+    constexpr int32_t rings_for(float radius) noexcept;
+
+    template <typename T, typename O, uint32_t N, typename C>
+    void query_radius(const hex_grid<T, O, N>& grid, const glm::vec2& center, float radius, C&& callback) noexcept;
+
+    // Fills `out` with up to `k` hits within `max_radius`, closest first
+    template <typename T, typename O, uint32_t N, typename A>
+    void nearest(const hex_grid<T, O, N>& grid, const glm::vec2& center, uint32_t k, float max_radius, std::vector<hit<T>, A>& out) noexcept;
+}
+
+
+template <typename O>
+constexpr float spatial::ring_min_distance(int32_t ring) noexcept
+{
+    return std::max(0.0f, (1.5f * static_cast<float>(ring) - 2.0f) * static_cast<float>(O::side_size));
+}
+
+template <typename O>
+constexpr int32_t spatial::rings_for(float radius) noexcept
+{
+    return static_cast<int32_t>((radius + 2.0f * O::side_size) / (1.5f * O::side_size));
+}
+
+template <typename T, typename O, uint32_t N, typename C>
+void spatial::query_radius(const hex_grid<T, O, N>& grid, const glm::vec2& center, float radius, C&& callback) noexcept
+{
+    const float radius_sq = radius * radius;
+
+    grid.disk(O::of(center.x, center.y), rings_for<O>(radius), [&](T* object) {
+        const auto& positions = object->positions();
+        for (uint32_t i = 0, size = static_cast<uint32_t>(positions.size()); i < size; ++i)
+        {
+            const glm::vec2 delta = positions[i] - center;
+            if (const float distance_sq = delta.x * delta.x + delta.y * delta.y; distance_sq <= radius_sq)
+            {
+                callback(object, i);
+            }
+        }
+    });
+}
+
+template <typename T, typename O, uint32_t N, typename A>
+void spatial::nearest(const hex_grid<T, O, N>& grid, const glm::vec2& center, uint32_t k, float max_radius, std::vector<hit<T>, A>& out) noexcept
+{
+    out.clear();
+    if (k == 0)
+    {
+        return;
+    }
+
+    const float radius_sq = max_radius * max_radius;
+    const O origin = O::of(center.x, center.y);
+    auto closer = [](const hit<T>& lhs, const hit<T>& rhs) {
+        return lhs.distance_sq < rhs.distance_sq;
+    };
+
+    // `out` is kept as a max-heap of the best `k` so far
+    for (int32_t ring = 0, last = rings_for<O>(max_radius); ring <= last; ++ring)
+    {
+        // Nothing further away can beat what we already have
+        if (out.size() == k)
+        {
+            const float bound = ring_min_distance<O>(ring);
+            if (bound * bound > out.front().distance_sq)
+            {
+                break;
+            }
+        }
+
+        grid.ring(origin, ring, [&](T* object) {
+            const auto& positions = object->positions();
+            for (uint32_t i = 0, size = static_cast<uint32_t>(positions.size()); i < size; ++i)
+            {
+                const glm::vec2 delta = positions[i] - center;
+                const float distance_sq = delta.x * delta.x + delta.y * delta.y;
+                if (distance_sq > radius_sq)
+                {
+                    continue;
+                }
+
+                if (out.size() < k)
+                {
+                    out.push_back({ .object = object, .index = i, .distance_sq = distance_sq });
+                    std::push_heap(out.begin(), out.end(), closer);
+                }
+                else if (distance_sq < out.front().distance_sq)
+                {
+                    std::pop_heap(out.begin(), out.end(), closer);
+                    out.back() = { .object = object, .index = i, .distance_sq = distance_sq };
+                    std::push_heap(out.begin(), out.end(), closer);
+                }
+            }
+        });
+    }
+
+    std::sort_heap(out.begin(), out.end(), closer);
+}
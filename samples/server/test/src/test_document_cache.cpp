@@ -0,0 +1,186 @@
+#include <catch2/catch_all.hpp>
+
+#include <database/document_cache.hpp>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <mongocxx/model/delete_one.hpp>
+#include <mongocxx/model/insert_one.hpp>
+#include <mongocxx/model/update_many.hpp>
+#include <mongocxx/model/update_one.hpp>
+
+
+using bsoncxx::builder::basic::make_document;
+using bsoncxx::builder::basic::kvp;
+
+
+SCENARIO("write-behind document cache") {
+    GIVEN("A cache with a stored document") {
+        document_cache cache(1024 * 1024, 1024);
+        cache.store(cache.begin_read(), 0, make_document(kvp("_id", int64_t(1)), kvp("name", "alice"), kvp("level", 1)).view());
+
+        WHEN("it is read") {
+            auto document = cache.find(0, 1);
+
+            THEN("It is served from memory") {
+                REQUIRE(document);
+                REQUIRE(document->view()["level"].get_int32().value == 1);
+                REQUIRE(!cache.find(1, 1));
+            }
+        }
+
+        WHEN("a $set by id is queued") {
+            cache.apply(0, mongocxx::model::update_one(make_document(kvp("_id", int64_t(1))), make_document(kvp("$set", make_document(kvp("level", 2))))));
+
+            THEN("The cached document is updated in place") {
+                auto document = cache.find(0, 1);
+                REQUIRE(document);
+                REQUIRE(document->view()["level"].get_int32().value == 2);
+                REQUIRE(document->view()["name"].get_utf8().value == "alice");
+            }
+        }
+
+        WHEN("an update that can not be applied is queued") {
+            cache.apply(0, mongocxx::model::update_one(make_document(kvp("_id", int64_t(1))), make_document(kvp("$inc", make_document(kvp("level", 1))))));
+
+            THEN("The document is invalidated") {
+                REQUIRE(!cache.find(0, 1));
+            }
+        }
+
+        WHEN("an update without an id filter is queued") {
+            cache.apply(0, mongocxx::model::update_many(make_document(kvp("name", "alice")), make_document(kvp("$set", make_document(kvp("level", 5))))));
+
+            THEN("The document is invalidated") {
+                REQUIRE(!cache.find(0, 1));
+            }
+        }
+
+        WHEN("the document is deleted") {
+            cache.apply(0, mongocxx::model::delete_one(make_document(kvp("_id", int64_t(1)))));
+
+            THEN("It is no longer cached") {
+                REQUIRE(!cache.find(0, 1));
+            }
+        }
+    }
+
+    GIVEN("A cache with a stored query result") {
+        document_cache cache(1024 * 1024, 1024);
+
+        auto first = make_document(kvp("_id", int64_t(1)), kvp("username", "user"));
+        auto second = make_document(kvp("_id", int64_t(2)), kvp("username", "user"));
+        cache.store_list(cache.begin_read(), 0, "user", { first.view(), second.view() });
+
+        WHEN("it is read") {
+            auto documents = cache.find_list(0, "user");
+
+            THEN("All documents are returned in order") {
+                REQUIRE(documents);
+                REQUIRE(documents->size() == 2);
+                REQUIRE((*documents)[1].view()["_id"].get_int64().value == 2);
+            }
+        }
+
+        WHEN("a document is inserted into the collection") {
+            cache.apply(0, mongocxx::model::insert_one(make_document(kvp("_id", int64_t(3)), kvp("username", "user"))));
+
+            THEN("The query result is dropped but the new document is cached") {
+                REQUIRE(!cache.find_list(0, "user"));
+                REQUIRE(cache.find(0, 3));
+            }
+        }
+
+        WHEN("one of its documents is invalidated") {
+            cache.apply(0, mongocxx::model::update_one(make_document(kvp("_id", int64_t(2))), make_document(kvp("$unset", make_document(kvp("username", ""))))));
+
+            THEN("The partial result is not returned") {
+                REQUIRE(!cache.find_list(0, "user"));
+            }
+        }
+    }
+
+    GIVEN("A document read from the database") {
+        document_cache cache(1024 * 1024, 1024);
+
+        auto document = make_document(kvp("_id", int64_t(1)), kvp("level", 1));
+        auto update = [] {
+            return mongocxx::model::update_one(make_document(kvp("_id", int64_t(1))), make_document(kvp("$set", make_document(kvp("level", 2)))));
+        };
+
+        WHEN("a write to it is queued while reading") {
+            auto read = cache.begin_read();
+            auto write = cache.apply(0, update());
+            cache.store(read, 0, document.view());
+
+            THEN("The read is not cached") {
+                REQUIRE(!cache.find(0, 1));
+            }
+
+            AND_WHEN("the write is acknowledged and it is read again") {
+                cache.acknowledge(write);
+                cache.store(cache.begin_read(), 0, document.view());
+
+                THEN("It is cached") {
+                    REQUIRE(cache.find(0, 1));
+                }
+            }
+        }
+
+        WHEN("a write to it is still pending") {
+            auto write = cache.apply(0, update());
+            cache.store(cache.begin_read(), 0, document.view());
+
+            THEN("The read is not cached") {
+                REQUIRE(!cache.find(0, 1));
+            }
+        }
+
+        WHEN("a pending write is acknowledged while reading") {
+            auto write = cache.apply(0, update());
+            auto read = cache.begin_read();
+            cache.acknowledge(write);
+            cache.store(read, 0, document.view());
+
+            THEN("The read is not cached") {
+                REQUIRE(!cache.find(0, 1));
+            }
+        }
+
+        WHEN("a write to another document is pending") {
+            auto write = cache.apply(0, mongocxx::model::update_one(make_document(kvp("_id", int64_t(2))), make_document(kvp("$set", make_document(kvp("level", 2))))));
+            cache.store(cache.begin_read(), 0, document.view());
+
+            THEN("It is cached") {
+                REQUIRE(cache.find(0, 1));
+            }
+        }
+    }
+
+    GIVEN("A query read from the database") {
+        document_cache cache(1024 * 1024, 1024);
+
+        auto first = make_document(kvp("_id", int64_t(1)), kvp("username", "user"));
+
+        WHEN("a document is inserted while reading") {
+            auto read = cache.begin_read();
+            auto write = cache.apply(0, mongocxx::model::insert_one(make_document(kvp("_id", int64_t(2)), kvp("username", "user"))));
+            cache.acknowledge(write);
+            cache.store_list(read, 0, "user", { first.view() });
+
+            THEN("The query result is not cached") {
+                REQUIRE(!cache.find_list(0, "user"));
+            }
+        }
+
+        WHEN("a document is created outside transactions while reading") {
+            auto read = cache.begin_read();
+            cache.invalidate_lists(0);
+            cache.store_list(read, 0, "user", { first.view() });
+
+            THEN("The query result is not cached") {
+                REQUIRE(!cache.find_list(0, "user"));
+            }
+        }
+    }
+}
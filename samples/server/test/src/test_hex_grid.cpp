@@ -0,0 +1,206 @@
+#include <catch2/catch_all.hpp>
+
+#include <maps/hex_grid.hpp>
+#include <maps/offset.hpp>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+    using offset_t = offset<float, 15>;
+
+    struct tile
+    {
+        tile(int32_t x, int32_t y) :
+            x(x),
+            y(y)
+        {}
+
+        int32_t x;
+        int32_t y;
+    };
+
+    // Small chunks, so that few cells span many chunks
+    using grid_t = hex_grid<tile, offset_t, 4>;
+
+    template <typename C>
+    void fill_disk(grid_t& grid, const offset_t& center, int32_t radius, C&& callback)
+    {
+        for (int32_t dx = -radius; dx <= radius; ++dx)
+        {
+            for (int32_t dy = -radius; dy <= radius; ++dy)
+            {
+                const offset_t at(center.x() + dx, center.y() + dy);
+                if (center.distance(at) <= radius)
+                {
+                    callback(grid.get_or_emplace(at, at.x(), at.y()).first);
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("sparse hex grids") {
+    GIVEN("An empty grid") {
+        grid_t grid;
+
+        WHEN("objects are emplaced around the origin, on both sides of the sign change") {
+            std::vector<offset_t> offsets = {
+                { 0, 0 }, { -1, 0 }, { 0, -1 }, { -1, -1 },
+                { 3, 3 }, { -4, -4 }, { -5, 4 }, { 4, -5 },
+                { -17, -33 }, { -100000, 100000 }
+            };
+
+            std::vector<tile*> created;
+            for (const auto& at : offsets)
+            {
+                auto [object, inserted] = grid.get_or_emplace(at, at.x(), at.y());
+                REQUIRE(inserted);
+                created.push_back(object);
+            }
+
+            THEN("Every one of them is a different object, found at its own offset") {
+                REQUIRE(grid.size() == offsets.size());
+                REQUIRE(std::set<tile*>(created.begin(), created.end()).size() == offsets.size());
+
+                for (std::size_t i = 0; i < offsets.size(); ++i)
+                {
+                    REQUIRE(grid.get(offsets[i]) == created[i]);
+                    REQUIRE(created[i]->x == offsets[i].x());
+                    REQUIRE(created[i]->y == offsets[i].y());
+                }
+            }
+
+            THEN("Emplacing again returns the existing object") {
+                auto [object, inserted] = grid.get_or_emplace(offset_t(-4, -4), 0, 0);
+                REQUIRE(!inserted);
+                REQUIRE(object == created[5]);
+                REQUIRE(object->x == -4);
+                REQUIRE(grid.size() == offsets.size());
+            }
+
+            THEN("Empty offsets, even in existing chunks, are not found") {
+                REQUIRE(!grid.get(offset_t(-2, -1)));
+                REQUIRE(!grid.get(offset_t(1, 0)));
+                REQUIRE(!grid.get(offset_t(-1000, -1000)));
+            }
+        }
+
+        WHEN("objects are spread over many chunks") {
+            std::vector<std::pair<offset_t, tile*>> created;
+            for (int32_t x = -64; x < 64; x += 3)
+            {
+                for (int32_t y = -64; y < 64; y += 5)
+                {
+                    const offset_t at(x, y);
+                    created.push_back({ at, grid.get_or_emplace(at, x, y).first });
+                }
+            }
+
+            THEN("Objects do not move while the chunk table grows") {
+                REQUIRE(grid.size() == created.size());
+                for (const auto& [at, object] : created)
+                {
+                    REQUIRE(grid.get(at) == object);
+                    REQUIRE(object->x == at.x());
+                    REQUIRE(object->y == at.y());
+                }
+            }
+
+            THEN("Each visits all of them once") {
+                std::set<tile*> visited;
+                grid.each([&visited](tile* object) {
+                    REQUIRE(visited.insert(object).second);
+                });
+
+                REQUIRE(visited.size() == created.size());
+            }
+        }
+    }
+
+    GIVEN("A grid filled around a negative center") {
+        grid_t grid;
+        const offset_t center(-6, -3);
+        fill_disk(grid, center, 4, [](tile*) {});
+
+        WHEN("a ring is walked") {
+            std::vector<tile*> visited;
+            grid.ring(center, 2, [&visited](tile* object) {
+                visited.push_back(object);
+            });
+
+            THEN("All objects exactly that far are visited once") {
+                REQUIRE(visited.size() == 12);
+                REQUIRE(std::set<tile*>(visited.begin(), visited.end()).size() == 12);
+                for (auto object : visited)
+                {
+                    REQUIRE(center.distance(offset_t(object->x, object->y)) == 2);
+                }
+            }
+        }
+
+        WHEN("a ring of radius zero is walked") {
+            std::vector<tile*> visited;
+            grid.ring(center, 0, [&visited](tile* object) {
+                visited.push_back(object);
+            });
+
+            THEN("Only the center is visited") {
+                REQUIRE(visited.size() == 1);
+                REQUIRE(visited[0] == grid.get(center));
+            }
+        }
+
+        WHEN("a disk is walked") {
+            std::set<tile*> visited;
+            grid.disk(center, 3, [&visited](tile* object) {
+                visited.insert(object);
+            });
+
+            THEN("All objects up to that distance are visited") {
+                REQUIRE(visited.size() == 1 + 6 + 12 + 18);
+                for (auto object : visited)
+                {
+                    REQUIRE(center.distance(offset_t(object->x, object->y)) <= 3);
+                }
+            }
+        }
+
+        WHEN("a disk reaches past the filled area") {
+            std::size_t visited = 0;
+            grid.disk(center, 6, [&visited](tile*) {
+                ++visited;
+            });
+
+            THEN("Missing cells are skipped") {
+                REQUIRE(visited == grid.size());
+                REQUIRE(grid.size() == 1 + 6 + 12 + 18 + 24);
+            }
+        }
+
+        WHEN("it is cleared") {
+            grid.clear();
+
+            THEN("It is empty") {
+                REQUIRE(grid.size() == 0);
+                REQUIRE(!grid.get(center));
+
+                std::size_t visited = 0;
+                grid.each([&visited](tile*) { ++visited; });
+                grid.disk(center, 4, [&visited](tile*) { ++visited; });
+                REQUIRE(visited == 0);
+            }
+
+            THEN("It can be filled again") {
+                auto [object, inserted] = grid.get_or_emplace(center, center.x(), center.y());
+                REQUIRE(inserted);
+                REQUIRE(grid.get(center) == object);
+                REQUIRE(grid.size() == 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_all.hpp>
+
+#include <database/log_backend.hpp>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+
+#include <chrono>
+
+
+using bsoncxx::builder::basic::make_document;
+using bsoncxx::builder::basic::kvp;
+
+
+SCENARIO("in-process log backend") {
+    GIVEN("A log backend without latency") {
+        log_backend backend;
+
+        WHEN("a bulk write is executed") {
+            std::vector<mongocxx::model::write> operations;
+            operations.push_back(mongocxx::model::insert_one(make_document(kvp("_id", 1))));
+            operations.push_back(mongocxx::model::update_one(make_document(kvp("_id", 1)), make_document(kvp("$set", make_document(kvp("level", 2))))));
+            operations.push_back(mongocxx::model::delete_one(make_document(kvp("_id", 1))));
+            backend.bulk_write(0, std::move(operations));
+
+            THEN("All operations are appended in order, in a single round trip") {
+                auto& records = backend.records(0);
+                REQUIRE(records.size() == 3);
+                REQUIRE(backend.round_trips() == 1);
+
+                REQUIRE(records[0].type == mongocxx::write_type::k_insert_one);
+                REQUIRE(records[1].type == mongocxx::write_type::k_update_one);
+                REQUIRE(records[2].type == mongocxx::write_type::k_delete_one);
+
+                REQUIRE(records[0].sequence < records[1].sequence);
+                REQUIRE(records[1].sequence < records[2].sequence);
+
+                REQUIRE(records[1].filter.view()["_id"].get_int32().value == 1);
+                REQUIRE(records[1].document.view()["$set"]["level"].get_int32().value == 2);
+            }
+
+            THEN("Other collections are untouched") {
+                REQUIRE(backend.records(1).empty());
+            }
+        }
+
+        WHEN("the same id is inserted twice") {
+            bool first = backend.insert(0, make_document(kvp("_id", "user")).view());
+            bool second = backend.insert(0, make_document(kvp("_id", "user")).view());
+            bool other = backend.insert(1, make_document(kvp("_id", "user")).view());
+
+            THEN("Only the first one per collection succeeds") {
+                REQUIRE(first);
+                REQUIRE(!second);
+                REQUIRE(other);
+                REQUIRE(backend.records(0).size() == 1);
+            }
+        }
+    }
+
+    GIVEN("A log backend with simulated latency") {
+        log_backend backend(std::chrono::milliseconds(5), std::chrono::milliseconds(1));
+
+        WHEN("a bulk write is executed") {
+            std::vector<mongocxx::model::write> operations;
+            for (int i = 0; i < 5; ++i)
+            {
+                operations.push_back(mongocxx::model::insert_one(make_document(kvp("_id", i))));
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            backend.bulk_write(0, std::move(operations));
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            THEN("It takes at least a round trip plus the per operation time") {
+                REQUIRE(elapsed >= std::chrono::milliseconds(10));
+            }
+        }
+    }
+}
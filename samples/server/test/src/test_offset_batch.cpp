@@ -0,0 +1,39 @@
+#include <catch2/catch_all.hpp>
+
+#include <maps/offset_batch.hpp>
+
+#include <random>
+#include <vector>
+
+
+SCENARIO("batched offsets match the scalar conversion") {
+    GIVEN("Random positions and positions right on cell boundaries") {
+        using offset_t = offset<float, 15>;
+
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<float> distribution(-50000.0f, 50000.0f);
+
+        std::vector<glm::vec3> positions;
+        for (int i = 0; i < 10003; ++i)
+        {
+            positions.push_back({ distribution(generator), 0.0f, distribution(generator) });
+        }
+
+        for (int i = -50; i < 50; ++i)
+        {
+            positions.push_back({ i * 7.5f, 0.0f, i * 4.33012701892f });
+        }
+
+        WHEN("they are converted in batch") {
+            std::vector<offset_t> offsets(positions.size(), offset_t(0, 0));
+            offsets_of(positions, std::span(offsets));
+
+            THEN("Every offset is the same as offset::of") {
+                for (std::size_t i = 0; i < positions.size(); ++i)
+                {
+                    REQUIRE(offsets[i] == offset_t::of(positions[i].x, positions[i].z));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#include <catch2/catch_all.hpp>
+
+#include <database/snowflake_id.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+SCENARIO("snowflake id generation") {
+    GIVEN("A generator shared by several threads") {
+        snowflake_id generator(7, 64);
+
+        WHEN("every thread requests ids") {
+            constexpr uint64_t num_threads = 4;
+            constexpr uint64_t ids_per_thread = 50000;
+
+            std::vector<std::vector<uint64_t>> ids(num_threads);
+            std::vector<std::thread> threads;
+            for (uint64_t t = 0; t < num_threads; ++t)
+            {
+                threads.emplace_back([&generator, &ids, t]() {
+                    snowflake_id::reservation block;
+                    for (uint64_t i = 0; i < ids_per_thread; ++i)
+                    {
+                        ids[t].push_back(generator.next(block));
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            THEN("There are no collisions") {
+                std::unordered_set<uint64_t> unique;
+                for (const auto& list : ids)
+                {
+                    unique.insert(list.begin(), list.end());
+                }
+
+                REQUIRE(unique.size() == num_threads * ids_per_thread);
+            }
+
+            THEN("Ids are positive, carry the shard and increase within a thread") {
+                for (const auto& list : ids)
+                {
+                    REQUIRE(std::is_sorted(list.begin(), list.end()));
+                    REQUIRE(std::all_of(list.begin(), list.end(), [](uint64_t id) {
+                        return (id >> 63) == 0 && snowflake_id::shard_of(id) == 7;
+                    }));
+                }
+            }
+        }
+    }
+
+    GIVEN("Two generators with different shards") {
+        snowflake_id first(1);
+        snowflake_id second(2);
+        snowflake_id::reservation first_block;
+        snowflake_id::reservation second_block;
+
+        WHEN("both generate ids at the same time") {
+            std::unordered_set<uint64_t> unique;
+            for (int i = 0; i < 10000; ++i)
+            {
+                unique.insert(first.next(first_block));
+                unique.insert(second.next(second_block));
+            }
+
+            THEN("They never collide") {
+                REQUIRE(unique.size() == 20000);
+            }
+        }
+    }
+
+    GIVEN("An id permutation") {
+        id_permutation permutation(0x1234);
+        snowflake_id generator(0);
+        snowflake_id::reservation block;
+
+        WHEN("ids are encoded") {
+            std::unordered_set<uint64_t> encoded;
+            bool reversible = true;
+            bool positive = true;
+            for (int i = 0; i < 10000; ++i)
+            {
+                const uint64_t id = generator.next(block);
+                const uint64_t public_id = permutation.encode(id);
+
+                encoded.insert(public_id);
+                reversible &= permutation.decode(public_id) == id;
+                positive &= (public_id >> 63) == 0;
+            }
+
+            THEN("They are unique, positive and can be decoded") {
+                REQUIRE(encoded.size() == 10000);
+                REQUIRE(reversible);
+                REQUIRE(positive);
+            }
+        }
+    }
+}
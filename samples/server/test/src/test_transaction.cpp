@@ -0,0 +1,144 @@
+#include <catch2/catch_all.hpp>
+
+#include <async/async_executor.hpp>
+#include <common/definitions.hpp>
+#include <database/database.hpp>
+#include <database/log_backend.hpp>
+#include <database/transaction.hpp>
+#include <database/write_coalescer.hpp>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <mongocxx/model/update_one.hpp>
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+
+using bsoncxx::builder::basic::make_document;
+using bsoncxx::builder::basic::kvp;
+
+
+namespace
+{
+    constexpr uint8_t collection = static_cast<uint8_t>(database_collections::characters);
+
+    // Workers can not be restarted, a single one is shared by all cases
+    async_executor_base* executor()
+    {
+        static auto executor = [] {
+            auto executor = new async_executor<static_cast<uint16_t>(FiberID::DatabaseWorker)>(1, 64);
+            executor->start();
+            return executor;
+        }();
+
+        return executor;
+    }
+
+    mongocxx::model::write set(int64_t id, const char* field, int32_t value)
+    {
+        return mongocxx::model::update_one(
+            make_document(kvp("_id", id)),
+            make_document(kvp("$set", make_document(kvp(field, value))))
+        );
+    }
+
+    // Ticks `transaction` until everything queued so far has been executed on `backend`
+    void execute(transaction& transaction, persistence_backend* backend)
+    {
+        write_coalescer coalescer(MaxCoalescedWrites);
+
+        // Callables wait for all previous writes
+        std::promise<void> executed;
+        auto done = executed.get_future();
+        transaction.push_callable(collection, [&executed](persistence_backend*) { executed.set_value(); });
+
+        while (done.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+        {
+            transaction.sync();
+            transaction.update(1, nullptr, executor(), &coalescer);
+            coalescer.flush(executor(), backend);
+        }
+
+        // There is a single worker, once this runs the callable task has fully returned
+        std::promise<void> drained;
+        executor()->submit([&drained]() { drained.set_value(); });
+        drained.get_future().wait();
+    }
+}
+
+
+SCENARIO("transaction write folding") {
+    database::initialize(std::make_unique<log_backend>());
+
+    GIVEN("Two keys on the same document") {
+        THEN("They are only equal if the field path is the same") {
+            REQUIRE(fold_key(1, "position") == fold_key(1, "position"));
+            REQUIRE(!(fold_key(1, "position") == fold_key(1, "position.x")));
+            REQUIRE(!(fold_key(1, "position") == fold_key(2, "position")));
+        }
+    }
+
+    GIVEN("A transaction") {
+        log_backend backend;
+        transaction transaction;
+        transaction.construct(0);
+
+        WHEN("the same key is written several times before sending") {
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 1));
+            transaction.push_operation(collection, fold_key(1, "level"), set(1, "level", 5));
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 2));
+            transaction.push_operation(collection, fold_key(2, "position"), set(2, "position", 7));
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 3));
+            execute(transaction, &backend);
+
+            THEN("Only the last write of each key reaches the database, in order") {
+                auto& records = backend.records(collection);
+                REQUIRE(records.size() == 3);
+                REQUIRE(records[0].document.view()["$set"]["level"].get_int32().value == 5);
+                REQUIRE(records[1].document.view()["$set"]["position"].get_int32().value == 7);
+                REQUIRE(records[2].filter.view()["_id"].get_int64().value == 1);
+                REQUIRE(records[2].document.view()["$set"]["position"].get_int32().value == 3);
+            }
+        }
+
+        WHEN("writes are not folded") {
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 1));
+            transaction.push_operation(collection, set(1, "position", 2));
+            execute(transaction, &backend);
+
+            THEN("All of them reach the database") {
+                REQUIRE(backend.records(collection).size() == 2);
+            }
+        }
+
+        WHEN("a callable is queued between writes to the same key") {
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 1));
+            transaction.push_callable(collection, [](persistence_backend*) {});
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 2));
+            execute(transaction, &backend);
+
+            THEN("Folding stops at it and both writes are sent") {
+                auto& records = backend.records(collection);
+                REQUIRE(records.size() == 2);
+                REQUIRE(records[0].document.view()["$set"]["position"].get_int32().value == 1);
+                REQUIRE(records[1].document.view()["$set"]["position"].get_int32().value == 2);
+            }
+        }
+
+        WHEN("a key is written again once its previous write was sent") {
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 1));
+            execute(transaction, &backend);
+
+            transaction.push_operation(collection, fold_key(1, "position"), set(1, "position", 2));
+            execute(transaction, &backend);
+
+            THEN("Both writes reach the database") {
+                auto& records = backend.records(collection);
+                REQUIRE(records.size() == 2);
+                REQUIRE(records[1].document.view()["$set"]["position"].get_int32().value == 2);
+            }
+        }
+    }
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "common/tao.hpp"
+#include "common/types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+
+// Playback order, commands are sorted by type and then by id
+enum class structural_command : uint8_t
+{
+    change_partition    = 0,
+    move                = 1,
+    destroy             = 2,
+    create              = 3
+};
+
+template <typename P>
+struct command
+{
+    entity_id_t id;
+    structural_command type;
+    P payload;
+};
+
+// Per-worker buffers of POD structural changes, recorded while orchestrators are
+//  write-locked (views/updaters) and played back at a sync point
+//  `A` is only used for the temporary sorted list built on playback
+template <typename P, uint16_t max_threads, typename A = std::allocator<command<P>>>
+class command_buffer
+{
+    static_assert(std::is_trivially_copyable_v<P>, "Command payloads must be trivially copyable");
+
+public:
+    using command_t = command<P>;
+
+    command_buffer() noexcept;
+
+    command_buffer(command_buffer&& other) noexcept = default;
+    command_buffer& operator=(command_buffer&& other) noexcept = default;
+
+    inline void create(entity_id_t id, const P& payload) noexcept;
+    inline void destroy(entity_id_t id, const P& payload) noexcept;
+    inline void move(entity_id_t id, const P& payload) noexcept;
+    inline void change_partition(entity_id_t id, const P& payload) noexcept;
+    inline void record(structural_command type, entity_id_t id, const P& payload) noexcept;
+
+    // Must not be called concurrently with any record
+    //  callback(structural_command, entity_id_t, const P&)
+    template <typename C>
+    void playback(C&& callback) noexcept;
+
+    inline bool empty() const noexcept;
+
+private:
+    inline std::vector<command_t>& get_buffer() noexcept;
+
+    inline std::atomic<uint16_t>& get_count() noexcept
+    {
+        static std::atomic<uint16_t> current = 0;
+        return current;
+    }
+
+private:
+    std::array<std::vector<command_t>, max_threads> _buffers;
+};
+
+
+template <typename P, uint16_t max_threads, typename A>
+command_buffer<P, max_threads, A>::command_buffer() noexcept :
+    _buffers()
+{}
+
+template <typename P, uint16_t max_threads, typename A>
+inline void command_buffer<P, max_threads, A>::create(entity_id_t id, const P& payload) noexcept
+{
+    record(structural_command::create, id, payload);
+}
+
+template <typename P, uint16_t max_threads, typename A>
+inline void command_buffer<P, max_threads, A>::destroy(entity_id_t id, const P& payload) noexcept
+{
+    record(structural_command::destroy, id, payload);
+}
+
+template <typename P, uint16_t max_threads, typename A>
+inline void command_buffer<P, max_threads, A>::move(entity_id_t id, const P& payload) noexcept
+{
+    record(structural_command::move, id, payload);
+}
+
+template <typename P, uint16_t max_threads, typename A>
+inline void command_buffer<P, max_threads, A>::change_partition(entity_id_t id, const P& payload) noexcept
+{
+    record(structural_command::change_partition, id, payload);
+}
+
+template <typename P, uint16_t max_threads, typename A>
+inline void command_buffer<P, max_threads, A>::record(structural_command type, entity_id_t id, const P& payload) noexcept
+{
+    get_buffer().push_back({ .id = id, .type = type, .payload = payload });
+}
+
+template <typename P, uint16_t max_threads, typename A>
+template <typename C>
+void command_buffer<P, max_threads, A>::playback(C&& callback) noexcept
+{
+    std::size_t total = 0;
+    const uint16_t count = get_count();
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        total += _buffers[i].size();
+    }
+
+    if (total == 0)
+    {
+        return;
+    }
+
+    // Gather all workers buffers, their capacity is kept from tick to tick
+    std::vector<command_t, A> sorted;
+    sorted.reserve(total);
+
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        sorted.insert(sorted.end(), _buffers[i].begin(), _buffers[i].end());
+        _buffers[i].clear();
+    }
+
+    // Stable, so that commands of the same kind on the same entity keep their recording order
+    std::stable_sort(sorted.begin(), sorted.end(), [](const command_t& lhs, const command_t& rhs) {
+        if (lhs.type != rhs.type)
+        {
+            return lhs.type < rhs.type;
+        }
+
+        return lhs.id < rhs.id;
+    });
+
+    for (const auto& command : sorted)
+    {
+        callback(command.type, command.id, command.payload);
+    }
+}
+
+template <typename P, uint16_t max_threads, typename A>
+inline bool command_buffer<P, max_threads, A>::empty() const noexcept
+{
+    for (const auto& buffer : _buffers)
+    {
+        if (!buffer.empty())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename P, uint16_t max_threads, typename A>
+inline std::vector<typename command_buffer<P, max_threads, A>::command_t>& command_buffer<P, max_threads, A>::get_buffer() noexcept
+{
+    // Saturates at `max_threads`, so that the count never wraps back into used buffers
+    thread_local uint16_t index = [this]() {
+        auto& count = get_count();
+        uint16_t current = count.load(std::memory_order_relaxed);
+        while (current < max_threads && !count.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+        return current;
+    }();
+
+    // Sharing a buffer would race with its owner, there is no safe fallback
+    if (index >= max_threads)
+    {
+        assert(false && "Too many threads recording commands");
+        std::abort();
+    }
+
+    return _buffers[index];
+}
+
+
+// Payload for structural changes that only involve schemes
+template <typename S>
+struct scheme_command
+{
+    S* from;
+    S* to;
+    bool predicate;
+};
+
+// Generic playback for `scheme_command`, creation requires arguments and must be handled by the caller
+template <typename S>
+void apply_scheme_command(structural_command type, entity_id_t id, const scheme_command<S>& payload) noexcept
+{
+    auto entity = payload.from->search(id);
+    if (!tao::get<0>(entity.downcast()))
+    {
+        // Already gone, same as an invalid ticket on `schedule_if`
+        return;
+    }
+
+    switch (type)
+    {
+        case structural_command::change_partition:
+            payload.from->change_partition(payload.predicate, tao::get<0>(entity.downcast()));
+            break;
+
+        case structural_command::move:
+            payload.from->move(*payload.to, entity);
+            break;
+
+        case structural_command::destroy:
+            payload.from->destroy(entity);
+            break;
+
+        case structural_command::create:
+            assert(false && "Scheme commands can't create entities");
+            break;
+    }
+}
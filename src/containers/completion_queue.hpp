@@ -0,0 +1,86 @@
+#pragma once
+
+#include "containers/ticket.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+// Results produced by other threads (ie. database workers) on behalf of an entity, delivered
+//  to the owning thread in a single pass. Producers only lock to append, the consumer swaps
+//  buffers and dispatches without locking, skipping entities whose ticket is gone
+//  Both buffers keep their capacity from drain to drain
+template <typename T, typename R>
+class completion_queue
+{
+public:
+    using ticket_t = typename ::ticket<T>::ptr;
+
+    struct completion
+    {
+        ticket_t ticket;
+        R result;
+    };
+
+    completion_queue() noexcept;
+
+    // Thread safe
+    template <typename... Args>
+    void push(ticket_t ticket, Args&&... args) noexcept;
+
+    // Must only be called from one thread at a time, callback(T*, R&)
+    //  Returns how many results were dispatched
+    template <typename C>
+    std::size_t drain(C&& callback) noexcept;
+
+private:
+    std::mutex _mutex;
+    std::vector<completion> _pending;
+    std::vector<completion> _draining;
+};
+
+
+template <typename T, typename R>
+completion_queue<T, R>::completion_queue() noexcept :
+    _mutex(),
+    _pending(),
+    _draining()
+{}
+
+template <typename T, typename R>
+template <typename... Args>
+void completion_queue<T, R>::push(ticket_t ticket, Args&&... args) noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.push_back({ .ticket = std::move(ticket), .result = R { std::forward<Args>(args)... } });
+}
+
+template <typename T, typename R>
+template <typename C>
+std::size_t completion_queue<T, R>::drain(C&& callback) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pending.empty())
+        {
+            return 0;
+        }
+
+        std::swap(_pending, _draining);
+    }
+
+    std::size_t dispatched = 0;
+    for (auto& completion : _draining)
+    {
+        if (completion.ticket->valid())
+        {
+            callback(completion.ticket->get(), completion.result);
+            ++dispatched;
+        }
+    }
+
+    _draining.clear();
+    return dispatched;
+}
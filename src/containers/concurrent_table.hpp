@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+
+// Open addressing hash table with a single writer and any number (up to `max_readers`
+//  distinct threads) of lock-free readers
+//  Slots are written only once per table, erasing leaves a tombstone which is dropped
+//  when the table is grown/rehashed. Replaced tables are retired and only freed once
+//  no reader can still be holding them (epoch based reclamation)
+template <typename K, typename V, uint16_t max_readers, typename H = std::hash<K>>
+class concurrent_table
+{
+    enum class slot_state : uint8_t
+    {
+        empty       = 0,
+        full        = 1,
+        erased      = 2
+    };
+
+    struct slot
+    {
+        std::atomic<slot_state> state;
+        K key;
+        V value;
+    };
+
+    struct table
+    {
+        table(uint32_t capacity) noexcept;
+
+        std::unique_ptr<slot[]> slots;
+        uint32_t mask;
+    };
+
+    struct retired_table
+    {
+        table* ptr;
+        uint64_t epoch;
+    };
+
+public:
+    concurrent_table(uint32_t capacity = 64) noexcept;
+    ~concurrent_table() noexcept;
+
+    concurrent_table(const concurrent_table&) = delete;
+    concurrent_table& operator=(const concurrent_table&) = delete;
+
+    // Safe from any thread
+    std::optional<V> find(const K& key) const noexcept;
+    inline bool contains(const K& key) const noexcept;
+
+    // Writer thread only, returns false if the key already exists
+    bool insert(const K& key, const V& value) noexcept;
+    bool erase(const K& key) noexcept;
+
+    // Writer thread only, frees retired tables no reader can be using
+    void reclaim() noexcept;
+
+    inline uint32_t size() const noexcept;
+    inline uint32_t capacity() const noexcept;
+
+private:
+    inline std::atomic<uint64_t>& reader_epoch() const noexcept;
+    void grow() noexcept;
+
+    inline std::atomic<uint16_t>& get_count() const noexcept
+    {
+        static std::atomic<uint16_t> current = 0;
+        return current;
+    }
+
+private:
+    std::atomic<table*> _table;
+    mutable std::array<std::atomic<uint64_t>, max_readers> _reader_epochs;
+    std::atomic<uint64_t> _epoch;
+    std::vector<retired_table> _retired;
+    uint32_t _size;
+    uint32_t _used;
+};
+
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+concurrent_table<K, V, max_readers, H>::table::table(uint32_t capacity) noexcept :
+    slots(std::make_unique<slot[]>(capacity)),
+    mask(capacity - 1)
+{
+    assert((capacity & mask) == 0 && "Capacity must be a power of two");
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+concurrent_table<K, V, max_readers, H>::concurrent_table(uint32_t capacity) noexcept :
+    _table(nullptr),
+    _reader_epochs(),
+    _epoch(1),
+    _retired(),
+    _size(0),
+    _used(0)
+{
+    uint32_t rounded = 1;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+
+    _table = new table(rounded);
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+concurrent_table<K, V, max_readers, H>::~concurrent_table() noexcept
+{
+    for (auto& retired : _retired)
+    {
+        delete retired.ptr;
+    }
+
+    delete _table.load();
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+std::optional<V> concurrent_table<K, V, max_readers, H>::find(const K& key) const noexcept
+{
+    // Announce which epoch we are reading in before fetching the table
+    auto& epoch = reader_epoch();
+    epoch.store(_epoch.load());
+
+    std::optional<V> result = std::nullopt;
+    table* current = _table.load();
+
+    for (uint32_t idx = H{}(key) & current->mask; ; idx = (idx + 1) & current->mask)
+    {
+        slot& s = current->slots[idx];
+        slot_state state = s.state.load(std::memory_order_acquire);
+
+        if (state == slot_state::empty)
+        {
+            break;
+        }
+
+        // Tombstones keep their key, but the same key might have been inserted again further on
+        if (state == slot_state::full && s.key == key)
+        {
+            result = s.value;
+            break;
+        }
+    }
+
+    epoch.store(0, std::memory_order_release);
+    return result;
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+inline bool concurrent_table<K, V, max_readers, H>::contains(const K& key) const noexcept
+{
+    return find(key).has_value();
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+bool concurrent_table<K, V, max_readers, H>::insert(const K& key, const V& value) noexcept
+{
+    // Keep at most 3/4 of the slots used, counting tombstones
+    table* current = _table.load(std::memory_order_relaxed);
+    if ((_used + 1) * 4 > (current->mask + 1) * 3)
+    {
+        grow();
+        current = _table.load(std::memory_order_relaxed);
+    }
+
+    for (uint32_t idx = H{}(key) & current->mask; ; idx = (idx + 1) & current->mask)
+    {
+        slot& s = current->slots[idx];
+        slot_state state = s.state.load(std::memory_order_relaxed);
+
+        if (state == slot_state::full && s.key == key)
+        {
+            return false;
+        }
+
+        // Tombstones are never reused, readers might still be looking at them
+        if (state == slot_state::empty)
+        {
+            s.key = key;
+            s.value = value;
+            s.state.store(slot_state::full, std::memory_order_release);
+
+            ++_size;
+            ++_used;
+            return true;
+        }
+    }
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+bool concurrent_table<K, V, max_readers, H>::erase(const K& key) noexcept
+{
+    table* current = _table.load(std::memory_order_relaxed);
+
+    for (uint32_t idx = H{}(key) & current->mask; ; idx = (idx + 1) & current->mask)
+    {
+        slot& s = current->slots[idx];
+        slot_state state = s.state.load(std::memory_order_relaxed);
+
+        if (state == slot_state::empty)
+        {
+            return false;
+        }
+
+        if (state == slot_state::full && s.key == key)
+        {
+            s.state.store(slot_state::erased, std::memory_order_release);
+            --_size;
+            return true;
+        }
+    }
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+void concurrent_table<K, V, max_readers, H>::reclaim() noexcept
+{
+    if (_retired.empty())
+    {
+        return;
+    }
+
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (uint16_t i = 0, count = std::min<uint16_t>(get_count(), max_readers); i < count; ++i)
+    {
+        if (uint64_t epoch = _reader_epochs[i].load(); epoch != 0)
+        {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+
+    // Tables retired at epoch E can only be seen by readers that entered at E or before
+    auto it = std::remove_if(_retired.begin(), _retired.end(), [oldest](const retired_table& retired) {
+        if (retired.epoch < oldest)
+        {
+            delete retired.ptr;
+            return true;
+        }
+
+        return false;
+    });
+    _retired.erase(it, _retired.end());
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+inline uint32_t concurrent_table<K, V, max_readers, H>::size() const noexcept
+{
+    return _size;
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+inline uint32_t concurrent_table<K, V, max_readers, H>::capacity() const noexcept
+{
+    return _table.load(std::memory_order_relaxed)->mask + 1;
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+inline std::atomic<uint64_t>& concurrent_table<K, V, max_readers, H>::reader_epoch() const noexcept
+{
+    thread_local uint16_t index = get_count()++;
+    assert(index < max_readers && "Too many threads reading from the table");
+    return _reader_epochs[index];
+}
+
+template <typename K, typename V, uint16_t max_readers, typename H>
+void concurrent_table<K, V, max_readers, H>::grow() noexcept
+{
+    table* current = _table.load(std::memory_order_relaxed);
+
+    // Rehashing drops tombstones, only grow if there are actually that many live entries
+    uint32_t capacity = current->mask + 1;
+    while ((_size + 1) * 2 > capacity)
+    {
+        capacity <<= 1;
+    }
+
+    table* next = new table(capacity);
+    for (uint32_t i = 0; i <= current->mask; ++i)
+    {
+        slot& s = current->slots[i];
+        if (s.state.load(std::memory_order_relaxed) != slot_state::full)
+        {
+            continue;
+        }
+
+        uint32_t idx = H{}(s.key) & next->mask;
+        while (next->slots[idx].state.load(std::memory_order_relaxed) != slot_state::empty)
+        {
+            idx = (idx + 1) & next->mask;
+        }
+
+        next->slots[idx].key = s.key;
+        next->slots[idx].value = s.value;
+        next->slots[idx].state.store(slot_state::full, std::memory_order_relaxed);
+    }
+
+    _used = _size;
+
+    // Publish, then retire the old one with the epoch readers could have seen it in
+    _table.store(next);
+    _retired.push_back({ .ptr = current, .epoch = _epoch.fetch_add(1) });
+
+    reclaim();
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+
+// Least recently used cache with size accounting, each entry declares its own size and
+//  the oldest ones are evicted until the total fits in `capacity`
+//  Not thread safe, pointers returned by `get` are valid until the next modification
+template <typename K, typename V, typename H = std::hash<K>>
+class lru_cache
+{
+    struct entry
+    {
+        K key;
+        V value;
+        std::size_t size;
+    };
+
+public:
+    lru_cache(std::size_t capacity) noexcept;
+
+    // Marks the entry as the most recently used
+    V* get(const K& key) noexcept;
+
+    // Inserts or replaces, entries bigger than the whole capacity are not stored
+    void put(const K& key, V&& value, std::size_t size) noexcept;
+
+    bool erase(const K& key) noexcept;
+    void clear() noexcept;
+
+    inline std::size_t size() const noexcept;
+    inline std::size_t used() const noexcept;
+    inline std::size_t capacity() const noexcept;
+
+private:
+    void evict(std::size_t needed) noexcept;
+
+private:
+    std::size_t _capacity;
+    std::size_t _used;
+
+    // Front is the most recently used
+    std::list<entry> _entries;
+    std::unordered_map<K, typename std::list<entry>::iterator, H> _index;
+};
+
+
+template <typename K, typename V, typename H>
+lru_cache<K, V, H>::lru_cache(std::size_t capacity) noexcept :
+    _capacity(capacity),
+    _used(0),
+    _entries(),
+    _index()
+{}
+
+template <typename K, typename V, typename H>
+V* lru_cache<K, V, H>::get(const K& key) noexcept
+{
+    auto it = _index.find(key);
+    if (it == _index.end())
+    {
+        return nullptr;
+    }
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return &it->second->value;
+}
+
+template <typename K, typename V, typename H>
+void lru_cache<K, V, H>::put(const K& key, V&& value, std::size_t size) noexcept
+{
+    erase(key);
+
+    if (size > _capacity)
+    {
+        return;
+    }
+
+    evict(size);
+
+    _entries.push_front({ .key = key, .value = std::move(value), .size = size });
+    _index.emplace(key, _entries.begin());
+    _used += size;
+}
+
+template <typename K, typename V, typename H>
+bool lru_cache<K, V, H>::erase(const K& key) noexcept
+{
+    auto it = _index.find(key);
+    if (it == _index.end())
+    {
+        return false;
+    }
+
+    _used -= it->second->size;
+    _entries.erase(it->second);
+    _index.erase(it);
+    return true;
+}
+
+template <typename K, typename V, typename H>
+void lru_cache<K, V, H>::clear() noexcept
+{
+    _entries.clear();
+    _index.clear();
+    _used = 0;
+}
+
+template <typename K, typename V, typename H>
+inline std::size_t lru_cache<K, V, H>::size() const noexcept
+{
+    return _index.size();
+}
+
+template <typename K, typename V, typename H>
+inline std::size_t lru_cache<K, V, H>::used() const noexcept
+{
+    return _used;
+}
+
+template <typename K, typename V, typename H>
+inline std::size_t lru_cache<K, V, H>::capacity() const noexcept
+{
+    return _capacity;
+}
+
+template <typename K, typename V, typename H>
+void lru_cache<K, V, H>::evict(std::size_t needed) noexcept
+{
+    while (_used + needed > _capacity)
+    {
+        assert(!_entries.empty() && "Accounted size without entries");
+
+        auto& oldest = _entries.back();
+        _used -= oldest.size;
+        _index.erase(oldest.key);
+        _entries.pop_back();
+    }
+}
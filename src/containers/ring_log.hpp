@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <inttypes.h>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+// Append-only log addressed by monotonically increasing sequence numbers, completed entries
+//  are truncated from the front so memory is bounded by the live entries only
+//  Entries live in fixed size blocks which never move, pointers to them are valid until
+//  they are truncated, regardless of how many entries are appended meanwhile
+template <typename T, uint32_t block_size = 32>
+class ring_log
+{
+    static_assert((block_size & (block_size - 1)) == 0, "Block size must be a power of two");
+
+    struct block
+    {
+        alignas(T) std::byte storage[sizeof(T) * block_size];
+
+        inline T* at(uint64_t sequence) noexcept
+        {
+            return std::launder(reinterpret_cast<T*>(storage) + (sequence & (block_size - 1)));
+        }
+    };
+
+public:
+    ring_log() noexcept;
+    ~ring_log() noexcept;
+
+    ring_log(ring_log&& other) noexcept;
+    ring_log& operator=(ring_log&& other) noexcept;
+
+    ring_log(const ring_log&) = delete;
+    ring_log& operator=(const ring_log&) = delete;
+
+    // Returns the sequence number of the new entry
+    template <typename... Args>
+    uint64_t emplace(Args&&... args) noexcept;
+
+    // nullptr if the entry has been truncated or does not exist yet
+    inline T* get(uint64_t sequence) const noexcept;
+
+    // Drops entries from the front for as long as `predicate(entry)` holds
+    template <typename P>
+    void truncate_while(P&& predicate) noexcept;
+
+    void clear() noexcept;
+
+    inline uint64_t first() const noexcept;
+    inline uint64_t end() const noexcept;
+    inline std::size_t size() const noexcept;
+    inline bool empty() const noexcept;
+
+private:
+    void pop_front() noexcept;
+
+private:
+    std::deque<std::unique_ptr<block>> _blocks;
+    std::unique_ptr<block> _spare;
+    uint64_t _first;
+    uint64_t _end;
+};
+
+
+template <typename T, uint32_t block_size>
+ring_log<T, block_size>::ring_log() noexcept :
+    _blocks(),
+    _spare(nullptr),
+    _first(0),
+    _end(0)
+{}
+
+template <typename T, uint32_t block_size>
+ring_log<T, block_size>::~ring_log() noexcept
+{
+    clear();
+}
+
+template <typename T, uint32_t block_size>
+ring_log<T, block_size>::ring_log(ring_log&& other) noexcept :
+    _blocks(std::move(other._blocks)),
+    _spare(std::move(other._spare)),
+    _first(std::exchange(other._first, other._end)),
+    _end(other._end)
+{}
+
+template <typename T, uint32_t block_size>
+ring_log<T, block_size>& ring_log<T, block_size>::operator=(ring_log&& other) noexcept
+{
+    clear();
+
+    _blocks = std::move(other._blocks);
+    _spare = std::move(other._spare);
+    _first = std::exchange(other._first, other._end);
+    _end = other._end;
+
+    return *this;
+}
+
+template <typename T, uint32_t block_size>
+template <typename... Args>
+uint64_t ring_log<T, block_size>::emplace(Args&&... args) noexcept
+{
+    // Entering a new block, either the first one or the previous is full
+    if (_blocks.empty() || (_end & (block_size - 1)) == 0)
+    {
+        _blocks.push_back(_spare ? std::move(_spare) : std::make_unique<block>());
+    }
+
+    new (_blocks.back()->at(_end)) T(std::forward<Args>(args)...);
+    return _end++;
+}
+
+template <typename T, uint32_t block_size>
+inline T* ring_log<T, block_size>::get(uint64_t sequence) const noexcept
+{
+    if (sequence < _first || sequence >= _end)
+    {
+        return nullptr;
+    }
+
+    const std::size_t index = static_cast<std::size_t>(sequence / block_size - _first / block_size);
+    return _blocks[index]->at(sequence);
+}
+
+template <typename T, uint32_t block_size>
+template <typename P>
+void ring_log<T, block_size>::truncate_while(P&& predicate) noexcept
+{
+    while (_first != _end && predicate(*get(_first)))
+    {
+        pop_front();
+    }
+}
+
+template <typename T, uint32_t block_size>
+void ring_log<T, block_size>::clear() noexcept
+{
+    while (_first != _end)
+    {
+        pop_front();
+    }
+}
+
+template <typename T, uint32_t block_size>
+inline uint64_t ring_log<T, block_size>::first() const noexcept
+{
+    return _first;
+}
+
+template <typename T, uint32_t block_size>
+inline uint64_t ring_log<T, block_size>::end() const noexcept
+{
+    return _end;
+}
+
+template <typename T, uint32_t block_size>
+inline std::size_t ring_log<T, block_size>::size() const noexcept
+{
+    return static_cast<std::size_t>(_end - _first);
+}
+
+template <typename T, uint32_t block_size>
+inline bool ring_log<T, block_size>::empty() const noexcept
+{
+    return _first == _end;
+}
+
+template <typename T, uint32_t block_size>
+void ring_log<T, block_size>::pop_front() noexcept
+{
+    assert(_first != _end && "Log is empty");
+
+    get(_first)->~T();
+    ++_first;
+
+    // Release the block once all its entries are gone, or once the log is empty so that
+    //  the next entry does not expect a partially used block
+    if ((_first & (block_size - 1)) == 0 || _first == _end)
+    {
+        _spare = std::move(_blocks.front());
+        _blocks.pop_front();
+    }
+}
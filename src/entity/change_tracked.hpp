@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <inttypes.h>
+#include <type_traits>
+
+
+using change_epoch_t = uint64_t;
+
+// Global clock shared by all orchestrators, so that objects keep a comparable
+// epoch when they are moved across storages
+class change_epoch
+{
+public:
+    static inline change_epoch_t current() noexcept
+    {
+        return _current.load(std::memory_order_relaxed);
+    }
+
+    // Should only be called at a sync point, when no updater/view is running
+    static inline change_epoch_t advance() noexcept
+    {
+        return _current.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+private:
+    // Zero is reserved for "never changed"
+    static inline std::atomic<change_epoch_t> _current = 1;
+};
+
+
+// Opt-in mixin, must come after `entity<T>` in the bases list
+//  class transform : public entity<transform>, public change_tracked
+class change_tracked
+{
+public:
+    inline change_epoch_t changed_epoch() const noexcept
+    {
+        return _changed_epoch;
+    }
+
+    inline bool changed_since(change_epoch_t epoch) const noexcept
+    {
+        return _changed_epoch >= epoch;
+    }
+
+    inline void mark_changed() noexcept
+    {
+        _changed_epoch = change_epoch::current();
+    }
+
+private:
+    change_epoch_t _changed_epoch = 0;
+};
+
+template <typename T>
+concept is_change_tracked = std::is_base_of_v<change_tracked, T>;
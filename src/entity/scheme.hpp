@@ -261,6 +261,29 @@ public:
         return entities;
     }
 
+    // Links the components of an entity which already exists in the storages, ie. restored from
+    //  a snapshot, as `create` would. Returns false if any component is missing
+    bool relink(entity_id_t id) noexcept
+    {
+        auto entities = search(id);
+        bool complete = tao::apply([](auto... entities) {
+            return (... && (entities != nullptr));
+        }, entities.downcast());
+
+        if (!complete)
+        {
+            return false;
+        }
+
+        auto map = std::make_shared<components_map>(entities.downcast());
+        tao::apply([this, &map](auto... entities) mutable {
+            (..., entities->base()->base_scheme_information(*this));
+            (..., entities->base()->base_scheme_created(map));
+        }, entities.downcast());
+
+        return true;
+    }
+
     template <typename T>
     constexpr void destroy(T* object)
     {
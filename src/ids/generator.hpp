@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <inttypes.h>
 
@@ -23,6 +24,39 @@ private:
     std::atomic<uint64_t> _current;
 };
 
+// Same ids space as `generator`, but each thread reserves `block_size` consecutive ids at
+//  once and hands them out without touching the shared counter. Ids are unique but only
+//  increasing within a thread. Threads past `max_threads` fall back to one atomic per id
+template <uint16_t max_threads = 64, uint32_t block_size = 4096>
+class block_generator
+{
+    // One cache line each, they are only written by their owning thread
+    struct alignas(64) reservation
+    {
+        uint64_t next = 0;
+        uint64_t end = 0;
+    };
+
+public:
+    constexpr block_generator() noexcept;
+
+    // Upper bound of any id handed out so far
+    inline uint64_t peek() const noexcept;
+    inline uint64_t next() noexcept;
+
+private:
+    inline std::atomic<uint16_t>& get_count() noexcept
+    {
+        static std::atomic<uint16_t> current = 0;
+        return current;
+    }
+
+private:
+    // First id not yet reserved by any thread
+    alignas(64) std::atomic<uint64_t> _current;
+    std::array<reservation, max_threads> _reservations;
+};
+
 
 constexpr generator::generator() noexcept:
     _current(0)
@@ -37,3 +71,42 @@ inline conditional_constexpr uint64_t generator::next() noexcept
 {
     return _current++;
 }
+
+
+template <uint16_t max_threads, uint32_t block_size>
+constexpr block_generator<max_threads, block_size>::block_generator() noexcept :
+    _current(0),
+    _reservations()
+{}
+
+template <uint16_t max_threads, uint32_t block_size>
+inline uint64_t block_generator<max_threads, block_size>::peek() const noexcept
+{
+    return _current;
+}
+
+template <uint16_t max_threads, uint32_t block_size>
+inline uint64_t block_generator<max_threads, block_size>::next() noexcept
+{
+    // Saturates at `max_threads`, so that the count never wraps back into owned slots
+    thread_local uint16_t index = [this]() {
+        auto& count = get_count();
+        uint16_t current = count.load(std::memory_order_relaxed);
+        while (current < max_threads && !count.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+        return current;
+    }();
+
+    if (index >= max_threads)
+    {
+        return _current.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto& reservation = _reservations[index];
+    if (reservation.next == reservation.end)
+    {
+        reservation.next = _current.fetch_add(block_size, std::memory_order_relaxed);
+        reservation.end = reservation.next + block_size;
+    }
+
+    return reservation.next++;
+}
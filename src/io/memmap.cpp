@@ -10,12 +10,129 @@
     #include <Windows.h>
 #endif
 
+
+namespace
+{
+    // Returns the page aligned [begin, end) covering [offset, offset + length) of the mapping
+    bool page_range(const file_mapping& fp, uint64_t offset, uint64_t length, char*& begin, uint64_t& size)
+    {
+        if (!fp.addr || offset >= fp.length)
+        {
+            return false;
+        }
+
+        if (length == 0 || length > fp.length - offset)
+        {
+            length = fp.length - offset;
+        }
+
+    #ifdef __unix__
+        const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    #else
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        const uint64_t page = static_cast<uint64_t>(info.dwPageSize);
+    #endif
+
+        const uint64_t aligned = offset - (offset % page);
+        begin = fp.addr + aligned;
+        size = length + (offset - aligned);
+        return true;
+    }
+
+    bool map_view(file_mapping& fp)
+    {
+        if (fp.length == 0)
+        {
+            fp.addr = nullptr;
+            return true;
+        }
+
+    #ifdef __unix__
+        const int protection = fp.access == map_access::read_write ? PROT_READ | PROT_WRITE : PROT_READ;
+        const int flags = fp.access == map_access::read_write ? MAP_SHARED : MAP_PRIVATE;
+
+        void* addr = mmap(NULL, static_cast<size_t>(fp.length), protection, flags, fp.fd, 0u);
+        if (addr == MAP_FAILED)
+        {
+            return false;
+        }
+
+        fp.addr = static_cast<char*>(addr);
+    #else
+        const DWORD protection = fp.access == map_access::read_write ? PAGE_READWRITE : PAGE_READONLY;
+        const DWORD view_access = fp.access == map_access::read_write ? FILE_MAP_WRITE | FILE_MAP_READ : FILE_MAP_READ;
+
+        fp.map_handle = CreateFileMapping(fp.hfile, NULL, protection, static_cast<DWORD>(fp.length >> 32), static_cast<DWORD>(fp.length), NULL);
+        if (fp.map_handle == NULL)
+        {
+            return false;
+        }
+
+        fp.addr = static_cast<char*>(MapViewOfFile(fp.map_handle, view_access, 0, 0, 0));
+        if (fp.addr == NULL)
+        {
+            CloseHandle(fp.map_handle);
+            fp.map_handle = NULL;
+            return false;
+        }
+    #endif
+
+        return true;
+    }
+
+    void unmap_view(file_mapping& fp)
+    {
+        if (!fp.addr)
+        {
+            return;
+        }
+
+    #ifdef __unix__
+        munmap(fp.addr, static_cast<size_t>(fp.length));
+    #else
+        UnmapViewOfFile(fp.addr);
+        CloseHandle(fp.map_handle);
+        fp.map_handle = NULL;
+    #endif
+
+        fp.addr = nullptr;
+    }
+
+    bool truncate_file(file_mapping& fp, uint64_t length)
+    {
+    #ifdef __unix__
+        return ftruncate(fp.fd, static_cast<off_t>(length)) == 0;
+    #else
+        LARGE_INTEGER position;
+        position.QuadPart = static_cast<LONGLONG>(length);
+        return SetFilePointerEx(fp.hfile, position, NULL, FILE_BEGIN) && SetEndOfFile(fp.hfile);
+    #endif
+    }
+
+    void close_file(file_mapping& fp)
+    {
+    #ifdef __unix__
+        close(fp.fd);
+    #else
+        CloseHandle(fp.hfile);
+    #endif
+    }
+}
+
 std::optional<file_mapping> map_file(const char* filepath)
+{
+    return map_file(filepath, map_access::read_only);
+}
+
+std::optional<file_mapping> map_file(const char* filepath, map_access access, uint64_t min_length)
 {
     file_mapping file_mapping;
+    file_mapping.addr = nullptr;
+    file_mapping.access = access;
 
     #ifdef __unix__
-        file_mapping.fd = open(filepath, O_RDONLY);
+        file_mapping.fd = access == map_access::read_write ? open(filepath, O_RDWR | O_CREAT, 0644) : open(filepath, O_RDONLY);
         if (file_mapping.fd == -1)
         {
             return {};
@@ -25,57 +142,167 @@ std::optional<file_mapping> map_file(const char* filepath)
         struct stat sb;
         if (fstat(file_mapping.fd, &sb) == -1)
         {
+            close(file_mapping.fd);
             return {};
         }
 
-        file_mapping.length = sb.st_size;
-
-        file_mapping.addr = static_cast<const char*>(mmap(NULL, file_mapping.length, PROT_READ, MAP_PRIVATE, file_mapping.fd, 0u));
-        if (file_mapping.addr == MAP_FAILED)
-        {
-            return {};
-        }
+        file_mapping.length = static_cast<uint64_t>(sb.st_size);
     #else
-        file_mapping.hfile = CreateFileA(filepath, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        const DWORD file_access = access == map_access::read_write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+        const DWORD disposition = access == map_access::read_write ? OPEN_ALWAYS : OPEN_EXISTING;
+
+        file_mapping.map_handle = NULL;
+        file_mapping.hfile = CreateFileA(filepath, file_access, FILE_SHARE_READ, NULL, disposition, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
         if (file_mapping.hfile == INVALID_HANDLE_VALUE)
         {
             return {};
         }
 
-        file_mapping.length = GetFileSize(file_mapping.hfile, NULL);
-        if (file_mapping.length == INVALID_FILE_SIZE)
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_mapping.hfile, &size))
         {
             CloseHandle(file_mapping.hfile);
             return {};
         }
 
-        file_mapping.map_handle = CreateFileMapping(file_mapping.hfile, NULL, PAGE_READWRITE | SEC_RESERVE, 0, 0, 0);
-        if (file_mapping.map_handle == NULL)
+        file_mapping.length = static_cast<uint64_t>(size.QuadPart);
+    #endif
+
+    if (access == map_access::read_write && file_mapping.length < min_length)
+    {
+        if (!truncate_file(file_mapping, min_length))
         {
-            CloseHandle(file_mapping.hfile);
+            close_file(file_mapping);
             return {};
         }
 
-        file_mapping.addr = static_cast<const char*>(MapViewOfFile(file_mapping.map_handle, FILE_MAP_WRITE | FILE_MAP_READ, 0, 0, 0));
-        if (file_mapping.addr == NULL)
+        file_mapping.length = min_length;
+    }
+
+    if (!map_view(file_mapping))
+    {
+        close_file(file_mapping);
+        return {};
+    }
+
+    return file_mapping;
+}
+
+void unmap_file(const file_mapping& fp)
+{
+    file_mapping copy = fp;
+    unmap_view(copy);
+    close_file(copy);
+}
+
+bool resize_mapping(file_mapping& fp, uint64_t length)
+{
+    if (fp.access != map_access::read_write)
+    {
+        return false;
+    }
+
+    #if defined(__linux__)
+        // Growing in place avoids tearing down the page tables
+        if (fp.addr && length > 0)
         {
-            CloseHandle(file_mapping.map_handle);
-            CloseHandle(file_mapping.hfile);
-            return {};
+            if (!truncate_file(fp, length))
+            {
+                return false;
+            }
+
+            void* addr = mremap(fp.addr, static_cast<size_t>(fp.length), static_cast<size_t>(length), MREMAP_MAYMOVE);
+            if (addr == MAP_FAILED)
+            {
+                // The view still covers the old length
+                truncate_file(fp, fp.length);
+                return false;
+            }
+
+            fp.addr = static_cast<char*>(addr);
+            fp.length = length;
+            return true;
         }
     #endif
 
-    return file_mapping;
+    // Views can't outlive a shrinking file, remap from scratch
+    unmap_view(fp);
+
+    const uint64_t previous = fp.length;
+    if (!truncate_file(fp, length))
+    {
+        map_view(fp);
+        return false;
+    }
+
+    fp.length = length;
+    if (!map_view(fp))
+    {
+        truncate_file(fp, previous);
+        fp.length = previous;
+        map_view(fp);
+        return false;
+    }
+
+    return true;
 }
 
-void unmap_file(const file_mapping& fp)
+bool advise_mapping(const file_mapping& fp, map_advice advice, uint64_t offset, uint64_t length)
 {
+    char* begin;
+    uint64_t size;
+    if (!page_range(fp, offset, length, begin, size))
+    {
+        return false;
+    }
+
     #ifdef __unix__
-        munmap((void*)fp.addr, fp.length);
-        close(fp.fd);
+        int flag = MADV_NORMAL;
+        switch (advice)
+        {
+            case map_advice::normal:        flag = MADV_NORMAL; break;
+            case map_advice::sequential:    flag = MADV_SEQUENTIAL; break;
+            case map_advice::random:        flag = MADV_RANDOM; break;
+            case map_advice::will_need:     flag = MADV_WILLNEED; break;
+            case map_advice::dont_need:     flag = MADV_DONTNEED; break;
+        }
+
+        return madvise(begin, static_cast<size_t>(size), flag) == 0;
     #else
-        UnmapViewOfFile(fp.addr);
-        CloseHandle(fp.map_handle);
-        CloseHandle(fp.hfile);
+        // Only prefetching has an equivalent, the rest are hints anyway
+        if (advice == map_advice::will_need)
+        {
+            WIN32_MEMORY_RANGE_ENTRY range { .VirtualAddress = begin, .NumberOfBytes = static_cast<SIZE_T>(size) };
+            return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+
+        return true;
+    #endif
+}
+
+bool flush_mapping(const file_mapping& fp, uint64_t offset, uint64_t length, bool wait)
+{
+    if (fp.access != map_access::read_write)
+    {
+        return false;
+    }
+
+    char* begin;
+    uint64_t size;
+    if (!page_range(fp, offset, length, begin, size))
+    {
+        // Nothing mapped, nothing to flush
+        return fp.length == 0;
+    }
+
+    #ifdef __unix__
+        return msync(begin, static_cast<size_t>(size), wait ? MS_SYNC : MS_ASYNC) == 0;
+    #else
+        if (!FlushViewOfFile(begin, static_cast<SIZE_T>(size)))
+        {
+            return false;
+        }
+
+        return !wait || FlushFileBuffers(fp.hfile);
     #endif
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <inttypes.h>
 #include <optional>
 
 #ifdef _WIN32
@@ -7,6 +8,21 @@
 #endif
 
 
+enum class map_access : uint8_t
+{
+    read_only   = 0,    // Private, the file is never written
+    read_write  = 1     // Shared, writes reach the file (see `flush_mapping`)
+};
+
+enum class map_advice : uint8_t
+{
+    normal      = 0,
+    sequential  = 1,
+    random      = 2,
+    will_need   = 3,    // Starts reading the range ahead
+    dont_need   = 4
+};
+
 struct file_mapping
 {
 #ifdef __unix__
@@ -15,9 +31,21 @@ struct file_mapping
     HANDLE hfile;
     HANDLE map_handle;
 #endif
-    const char* addr;
-    int length;
+    // Only writable with `map_access::read_write`, nullptr for empty files
+    char* addr;
+    uint64_t length;
+    map_access access;
 };
 
 std::optional<file_mapping> map_file(const char* filepath);
-void unmap_file(const file_mapping& fp);
\ No newline at end of file
+
+// With `read_write` the file is created if needed and grown to at least `min_length`
+std::optional<file_mapping> map_file(const char* filepath, map_access access, uint64_t min_length = 0);
+void unmap_file(const file_mapping& fp);
+
+// Grows or shrinks both the file and the mapping, `addr` might change
+bool resize_mapping(file_mapping& fp, uint64_t length);
+
+// Ranges are rounded out to whole pages, a `length` of 0 means up to the end
+bool advise_mapping(const file_mapping& fp, map_advice advice, uint64_t offset = 0, uint64_t length = 0);
+bool flush_mapping(const file_mapping& fp, uint64_t offset = 0, uint64_t length = 0, bool wait = true);
@@ -0,0 +1,55 @@
+#include "io/snapshot.hpp"
+
+#include <cstdio>
+
+
+snapshot_writer::snapshot_writer() noexcept :
+    _data()
+{}
+
+void snapshot_writer::write(const void* data, std::size_t size) noexcept
+{
+    const char* bytes = static_cast<const char*>(data);
+    _data.insert(_data.end(), bytes, bytes + size);
+}
+
+bool snapshot_writer::save(const char* filepath) const noexcept
+{
+    FILE* file = std::fopen(filepath, "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    const bool written = std::fwrite(_data.data(), 1, _data.size(), file) == _data.size();
+    return (std::fclose(file) == 0) && written;
+}
+
+snapshot_reader::snapshot_reader(const char* data, std::size_t size) noexcept :
+    _data(data),
+    _size(size),
+    _offset(0)
+{}
+
+bool snapshot_reader::read(void* data, std::size_t size) noexcept
+{
+    if (const char* bytes = take(size))
+    {
+        std::memcpy(data, bytes, size);
+        return true;
+    }
+
+    return false;
+}
+
+const char* snapshot_reader::take(std::size_t size) noexcept
+{
+    if (size > remaining())
+    {
+        return nullptr;
+    }
+
+    const char* bytes = _data + _offset;
+    _offset += size;
+    return bytes;
+}
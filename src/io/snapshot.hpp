@@ -0,0 +1,434 @@
+#pragma once
+
+#include "entity/entity.hpp"
+#include "entity/scheme.hpp"
+#include "io/memmap.hpp"
+#include "storage/storage.hpp"
+
+#include <traits/ctti.hpp>
+
+#include <tao/tuple/tuple.hpp>
+
+#include <cassert>
+#include <concepts>
+#include <cstring>
+#include <inttypes.h>
+#include <type_traits>
+#include <vector>
+
+
+class snapshot_writer
+{
+public:
+    snapshot_writer() noexcept;
+
+    template <typename V>
+    inline void write(const V& value) noexcept;
+    void write(const void* data, std::size_t size) noexcept;
+
+    // Leaves room for a value that is only known later, see `patch`
+    template <typename V>
+    inline std::size_t reserve() noexcept;
+
+    template <typename V>
+    inline void patch(std::size_t offset, const V& value) noexcept;
+
+    inline std::size_t size() const noexcept;
+    bool save(const char* filepath) const noexcept;
+
+private:
+    std::vector<char> _data;
+};
+
+// Bounds checked view over snapshot bytes, nothing is copied until read
+class snapshot_reader
+{
+public:
+    snapshot_reader(const char* data, std::size_t size) noexcept;
+
+    template <typename V>
+    inline bool read(V& value) noexcept;
+    bool read(void* data, std::size_t size) noexcept;
+
+    // nullptr if there are not enough bytes left
+    const char* take(std::size_t size) noexcept;
+
+    inline std::size_t remaining() const noexcept;
+
+private:
+    const char* _data;
+    std::size_t _size;
+    std::size_t _offset;
+};
+
+
+// Components opt into snapshots either by declaring
+//  `static constexpr bool trivially_relocatable = true;` if all their members (not those of
+//  `entity`) can be copied as raw bytes, or by implementing
+//  `void serialize(snapshot_writer&) const` and `bool deserialize(snapshot_reader&)`
+//  Anything else is left out of snapshots
+template <typename T>
+concept snapshot_relocatable = requires { requires T::trivially_relocatable; };
+
+template <typename T>
+concept snapshot_serializable = requires(const T& object, T& target, snapshot_writer& writer, snapshot_reader& reader)
+{
+    { object.serialize(writer) };
+    { target.deserialize(reader) } -> std::same_as<bool>;
+};
+
+template <typename T>
+concept snapshotable = snapshot_relocatable<T> || snapshot_serializable<T>;
+
+
+namespace snapshot
+{
+    // "UMIS", bump `version` whenever the layout below changes
+    constexpr inline uint32_t magic = 0x53494D55;
+    constexpr inline uint32_t version = 1;
+
+    enum class encoding : uint8_t
+    {
+        raw         = 0,
+        hooks       = 1
+    };
+
+    struct file_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t sections;
+        uint32_t reserved;
+    };
+
+    // One per orchestrator, followed by `count` objects as
+    //  [ id (8) | partition (1, partitioned only) | raw bytes or length (4) + hook bytes ]
+    struct section_header
+    {
+        uint32_t type;
+        uint32_t object_size;
+        uint64_t count;
+        uint64_t bytes;
+        encoding format;
+        uint8_t partitioned;
+        uint8_t reserved[6];
+    };
+
+    // Saves every snapshotable orchestrator of the store
+    template <typename... comps>
+    bool save(scheme_store<comps...>& store, const char* filepath) noexcept;
+
+    // Pushes the snapshot contents into `store`, which is expected to be empty. Tickets are
+    //  created as objects are pushed, afterwards each scheme links its entities, schemes
+    //  sharing orchestrators must be given from the biggest to the smallest
+    //  Sections of unknown or no longer snapshotable components are skipped. Components
+    //  added through `push_component` are not restored
+    //  On failure the store is left partially restored
+    template <typename... comps, typename... S>
+    bool load(const char* filepath, scheme_store<comps...>& store, S&... schemes) noexcept;
+
+    template <typename... comps, typename... S>
+    bool load(snapshot_reader reader, scheme_store<comps...>& store, S&... schemes) noexcept;
+}
+
+
+namespace snapshot::detail
+{
+    // Raw components are copied around their `entity` base, which holds tickets and links.
+    //  `entity` only has pointer sized members, derived ones can't be in its tail padding
+    template <typename T>
+    inline std::size_t base_offset(const T* object) noexcept
+    {
+        return static_cast<std::size_t>(reinterpret_cast<const char*>(static_cast<const entity<T>*>(object)) - reinterpret_cast<const char*>(object));
+    }
+
+    template <typename T>
+    inline void write_payload(snapshot_writer& writer, const T* object) noexcept
+    {
+        const char* bytes = reinterpret_cast<const char*>(object);
+        const std::size_t offset = base_offset(object);
+
+        writer.write(bytes, offset);
+        writer.write(bytes + offset + sizeof(entity<T>), sizeof(T) - offset - sizeof(entity<T>));
+    }
+
+    template <typename T>
+    inline bool read_payload(snapshot_reader& reader, T* object) noexcept
+    {
+        char* bytes = reinterpret_cast<char*>(object);
+        const std::size_t offset = base_offset(object);
+
+        return reader.read(bytes, offset) &&
+            reader.read(bytes + offset + sizeof(entity<T>), sizeof(T) - offset - sizeof(entity<T>));
+    }
+
+    template <typename O>
+    uint32_t save_section(snapshot_writer& writer, O& orchestrator) noexcept
+    {
+        using T = typename O::derived_t;
+        constexpr bool partitioned = is_partitioned_storage(O::tag);
+
+        if constexpr (!snapshotable<T>)
+        {
+            return 0;
+        }
+        else
+        {
+            const std::size_t header_at = writer.reserve<section_header>();
+            const std::size_t start = writer.size();
+            uint64_t count = 0;
+
+            for (T* object : orchestrator.raw_storage().range())
+            {
+                writer.write(static_cast<uint64_t>(object->id()));
+                if constexpr (partitioned)
+                {
+                    writer.write(static_cast<uint8_t>(orchestrator.raw_storage().partition(object)));
+                }
+
+                if constexpr (snapshot_relocatable<T>)
+                {
+                    write_payload(writer, object);
+                }
+                else
+                {
+                    const std::size_t length_at = writer.reserve<uint32_t>();
+                    const std::size_t object_start = writer.size();
+                    object->serialize(writer);
+                    writer.patch(length_at, static_cast<uint32_t>(writer.size() - object_start));
+                }
+
+                ++count;
+            }
+
+            writer.patch(header_at, section_header {
+                .type = type_hash<T>(),
+                .object_size = static_cast<uint32_t>(sizeof(T)),
+                .count = count,
+                .bytes = static_cast<uint64_t>(writer.size() - start),
+                .format = snapshot_relocatable<T> ? encoding::raw : encoding::hooks,
+                .partitioned = partitioned,
+                .reserved = {}
+            });
+
+            return 1;
+        }
+    }
+
+    template <typename O>
+    bool load_section(snapshot_reader& reader, O& orchestrator, const section_header& section) noexcept
+    {
+        using T = typename O::derived_t;
+        constexpr bool partitioned = is_partitioned_storage(O::tag);
+
+        const char* bytes = reader.take(section.bytes);
+        if (!bytes)
+        {
+            return false;
+        }
+
+        if constexpr (!snapshotable<T>)
+        {
+            return true;
+        }
+        else
+        {
+            constexpr encoding expected = snapshot_relocatable<T> ? encoding::raw : encoding::hooks;
+            if (section.format != expected || section.partitioned != partitioned ||
+                (expected == encoding::raw && section.object_size != sizeof(T)))
+            {
+                return false;
+            }
+
+            snapshot_reader objects(bytes, section.bytes);
+            for (uint64_t i = 0; i < section.count; ++i)
+            {
+                uint64_t id;
+                if (!objects.read(id))
+                {
+                    return false;
+                }
+
+                T* object = nullptr;
+                if constexpr (partitioned)
+                {
+                    uint8_t partition;
+                    if (!objects.read(partition))
+                    {
+                        return false;
+                    }
+
+                    object = orchestrator.push(static_cast<bool>(partition), static_cast<entity_id_t>(id));
+                }
+                else
+                {
+                    object = orchestrator.push(static_cast<entity_id_t>(id));
+                }
+
+                if constexpr (snapshot_relocatable<T>)
+                {
+                    if (!read_payload(objects, object))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    uint32_t length;
+                    const char* payload = objects.read(length) ? objects.take(length) : nullptr;
+                    if (!payload)
+                    {
+                        return false;
+                    }
+
+                    snapshot_reader object_reader(payload, length);
+                    if (!object->deserialize(object_reader))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+    }
+
+    template <typename S>
+    void relink(S& scheme) noexcept
+    {
+        for (auto object : tao::get<0>(scheme.components)->raw_storage().range())
+        {
+            // Already claimed by a bigger scheme
+            if (!object->components())
+            {
+                scheme.relink(object->id());
+            }
+        }
+    }
+}
+
+
+template <typename V>
+inline void snapshot_writer::write(const V& value) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<V>, "Only trivially copyable values can be written directly");
+    write(&value, sizeof(V));
+}
+
+template <typename V>
+inline std::size_t snapshot_writer::reserve() noexcept
+{
+    const std::size_t offset = _data.size();
+    _data.resize(offset + sizeof(V));
+    return offset;
+}
+
+template <typename V>
+inline void snapshot_writer::patch(std::size_t offset, const V& value) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<V>, "Only trivially copyable values can be written directly");
+    assert(offset + sizeof(V) <= _data.size() && "Patching out of bounds");
+    std::memcpy(_data.data() + offset, &value, sizeof(V));
+}
+
+inline std::size_t snapshot_writer::size() const noexcept
+{
+    return _data.size();
+}
+
+template <typename V>
+inline bool snapshot_reader::read(V& value) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<V>, "Only trivially copyable values can be read directly");
+    return read(&value, sizeof(V));
+}
+
+inline std::size_t snapshot_reader::remaining() const noexcept
+{
+    return _size - _offset;
+}
+
+
+template <typename... comps>
+bool snapshot::save(scheme_store<comps...>& store, const char* filepath) noexcept
+{
+    snapshot_writer writer;
+    const std::size_t header_at = writer.reserve<file_header>();
+
+    uint32_t sections = 0;
+    tao::apply([&writer, &sections](auto&... orchestrators) {
+        (..., (sections += detail::save_section(writer, orchestrators)));
+    }, store.components);
+
+    writer.patch(header_at, file_header {
+        .magic = magic,
+        .version = version,
+        .sections = sections,
+        .reserved = 0
+    });
+
+    return writer.save(filepath);
+}
+
+template <typename... comps, typename... S>
+bool snapshot::load(const char* filepath, scheme_store<comps...>& store, S&... schemes) noexcept
+{
+    auto mapping = map_file(filepath);
+    if (!mapping)
+    {
+        return false;
+    }
+
+    // Read front to back exactly once
+    advise_mapping(*mapping, map_advice::sequential);
+    advise_mapping(*mapping, map_advice::will_need);
+
+    const bool result = load(snapshot_reader(mapping->addr, static_cast<std::size_t>(mapping->length)), store, schemes...);
+    unmap_file(*mapping);
+    return result;
+}
+
+template <typename... comps, typename... S>
+bool snapshot::load(snapshot_reader reader, scheme_store<comps...>& store, S&... schemes) noexcept
+{
+    file_header header;
+    if (!reader.read(header) || header.magic != magic || header.version != version)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.sections; ++i)
+    {
+        section_header section;
+        if (!reader.read(section))
+        {
+            return false;
+        }
+
+        bool found = false;
+        bool ok = true;
+        tao::apply([&reader, &section, &found, &ok](auto&... orchestrators) {
+            (..., [&](auto& orchestrator) {
+                if (!found && type_hash<typename std::decay_t<decltype(orchestrator)>::derived_t>() == section.type)
+                {
+                    found = true;
+                    ok = detail::load_section(reader, orchestrator, section);
+                }
+            }(orchestrators));
+        }, store.components);
+
+        // Components that no longer exist
+        if (!found)
+        {
+            ok = reader.take(section.bytes) != nullptr;
+        }
+
+        if (!ok)
+        {
+            return false;
+        }
+    }
+
+    (..., detail::relink(schemes));
+    return true;
+}
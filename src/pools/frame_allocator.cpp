@@ -0,0 +1,93 @@
+#include "pools/frame_allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+
+frame_arena::frame_arena() noexcept :
+    _blocks(),
+    _capacity(0),
+    _current(nullptr),
+    _end(nullptr),
+    _used(0)
+{
+    grow(block_size);
+
+    std::lock_guard<std::mutex> lock{ registry_mutex() };
+    registry().push_back(this);
+}
+
+frame_arena::~frame_arena() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{ registry_mutex() };
+        auto& arenas = registry();
+        arenas.erase(std::find(arenas.begin(), arenas.end(), this));
+    }
+
+    for (auto block : _blocks)
+    {
+        std::free(block);
+    }
+}
+
+void frame_arena::reset_all() noexcept
+{
+    std::lock_guard<std::mutex> lock{ registry_mutex() };
+    for (auto arena : registry())
+    {
+        arena->reset();
+    }
+}
+
+void* frame_arena::allocate(std::size_t size, std::size_t alignment) noexcept
+{
+    assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+    uintptr_t address = (reinterpret_cast<uintptr_t>(_current) + alignment - 1) & ~(alignment - 1);
+    if (address + size > reinterpret_cast<uintptr_t>(_end))
+    {
+        // Previous blocks are kept until the frame ends
+        grow(std::max(block_size, size + alignment));
+        address = (reinterpret_cast<uintptr_t>(_current) + alignment - 1) & ~(alignment - 1);
+    }
+
+    _current = reinterpret_cast<uint8_t*>(address + size);
+    _used += size;
+    return reinterpret_cast<void*>(address);
+}
+
+void frame_arena::reset() noexcept
+{
+    _used = 0;
+
+    // Frames that did not fit in a single block are merged, so that
+    //  steady state ticks only ever touch one block
+    if (_blocks.size() > 1)
+    {
+        std::size_t total = _capacity;
+        for (auto block : _blocks)
+        {
+            std::free(block);
+        }
+
+        _blocks.clear();
+        _capacity = 0;
+        grow(total);
+        return;
+    }
+
+    _current = _blocks.back();
+}
+
+void frame_arena::grow(std::size_t size) noexcept
+{
+    auto block = static_cast<uint8_t*>(std::malloc(size));
+    assert(block != nullptr && "Could not allocate frame memory");
+
+    _blocks.push_back(block);
+    _capacity += size;
+    _current = block;
+    _end = block + size;
+}
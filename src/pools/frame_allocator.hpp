@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <inttypes.h>
+#include <mutex>
+#include <vector>
+
+
+// Per-thread bump arena, all memory handed out is released at once on `reset_all`
+//  Only suitable for data that does not outlive the current frame/tick
+class frame_arena
+{
+public:
+    static constexpr std::size_t block_size = 64 * 1024;
+
+    frame_arena(const frame_arena&) = delete;
+    frame_arena(frame_arena&&) = delete;
+    frame_arena& operator=(const frame_arena&) = delete;
+    frame_arena& operator=(frame_arena&&) = delete;
+
+    ~frame_arena() noexcept;
+
+    static inline frame_arena& this_thread() noexcept
+    {
+        thread_local frame_arena arena;
+        return arena;
+    }
+
+    // Must be called when no thread is using frame memory, ie. at the end of a tick
+    static void reset_all() noexcept;
+
+    void* allocate(std::size_t size, std::size_t alignment) noexcept;
+    void reset() noexcept;
+
+    inline std::size_t used() const noexcept;
+
+private:
+    frame_arena() noexcept;
+
+    void grow(std::size_t size) noexcept;
+
+    static inline std::mutex& registry_mutex() noexcept
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static inline std::vector<frame_arena*>& registry() noexcept
+    {
+        static std::vector<frame_arena*> arenas;
+        return arenas;
+    }
+
+private:
+    std::vector<uint8_t*> _blocks;
+    std::size_t _capacity;
+    uint8_t* _current;
+    uint8_t* _end;
+    std::size_t _used;
+};
+
+
+inline std::size_t frame_arena::used() const noexcept
+{
+    return _used;
+}
+
+
+// std compatible allocator over the calling thread's arena, deallocation is a no-op
+template <typename T>
+class frame_allocator
+{
+public:
+    using value_type = T;
+
+    constexpr frame_allocator() noexcept = default;
+
+    template <typename U>
+    constexpr frame_allocator(const frame_allocator<U>&) noexcept
+    {}
+
+    inline T* allocate(std::size_t n) noexcept
+    {
+        return static_cast<T*>(frame_arena::this_thread().allocate(n * sizeof(T), alignof(T)));
+    }
+
+    inline void deallocate(T*, std::size_t) noexcept
+    {}
+
+    template <typename U>
+    constexpr bool operator==(const frame_allocator<U>&) const noexcept
+    {
+        return true;
+    }
+};
+
+template <typename T>
+using frame_vector = std::vector<T, frame_allocator<T>>;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "containers/pool_item.hpp"
+#include "entity/change_tracked.hpp"
 
+#include <range/v3/view/filter.hpp>
 #include <spdlog/spdlog.h>
 #include <atomic>
 #include <inttypes.h>
@@ -105,6 +107,13 @@ public:
         return _storage.range_from_partition();
     }
 
+    // Objects marked through `change_tracked::mark_changed` (or pushed/moved) at or after `epoch`
+    template <typename D = T, typename = std::enable_if_t<is_change_tracked<D>>>
+    inline auto range_changed_since(change_epoch_t epoch) noexcept
+    {
+        return ranges::views::filter(range(), [epoch](T* obj) { return obj->changed_since(epoch); });
+    }
+
 #if !defined(NDEBUG)
     inline void unlock_writes()
     {
@@ -181,6 +190,12 @@ T* orchestrator<storage, T, N>::push(Args&&... args) noexcept
 
     T* obj = _storage.push(std::forward<Args>(args)...);
     _tickets.emplace(obj->id(), obj->ticket());
+
+    if constexpr (is_change_tracked<T>)
+    {
+        obj->mark_changed();
+    }
+
     return obj;
 }
 
@@ -249,6 +264,12 @@ T* orchestrator<storage, T, N>::move(orchestrator<S, T, M>& other, T* obj, Args.
     // Add to dicts
     _tickets.erase(new_ptr->id());
     other._tickets.emplace(new_ptr->id(), new_ptr->ticket());
+
+    if constexpr (is_change_tracked<T>)
+    {
+        new_ptr->mark_changed();
+    }
+
     return new_ptr;
 }
 
@@ -377,7 +377,7 @@ public:
         });
     }
 
-    inline generator& id_generator() noexcept
+    inline block_generator<>& id_generator() noexcept
     {
         return _global_id_gen;
     }
@@ -415,8 +415,8 @@ protected:
     bool _stop;
 
 private:
-    // Helpers
-    generator _global_id_gen;
+    // Helpers, entities are mostly created from workers, avoid contending on a single counter
+    block_generator<> _global_id_gen;
 
     // Workers
     std::vector<std::thread> _workers;
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/condition_variable.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#if _WIN32
+    #undef min
+    #undef max
+#endif
+
+
+// Updates a runtime list of orchestrators of the same type as a single pool of
+//  similarly sized chunks, which a fixed amount of fibers pull from
+//  Orchestrators must provide random access ranges
+template <typename O>
+class updater_chunked
+{
+    using range_t = decltype(std::declval<O&>().range());
+
+    struct chunk
+    {
+        range_t range;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+public:
+    updater_chunked(uint32_t num_fibers, uint32_t min_grain) noexcept;
+
+    // Moving is only allowed while not updating, synchronization primitives are not transferred
+    updater_chunked(const updater_chunked&) = delete;
+    updater_chunked(updater_chunked&& other) noexcept;
+    updater_chunked& operator=(updater_chunked&& other) noexcept;
+
+    // Vectors must be gathered again before each update
+    inline void clear() noexcept;
+    inline void push(O* vector) noexcept;
+
+    template <typename... Args>
+    void update(Args&&... args) noexcept;
+
+    // Hands whole chunks to `callback(begin, end)` instead of updating one object at a time,
+    //  for updates that are cheaper in batches. Each fiber gets its own copy of the callback
+    template <typename C>
+    void update_chunks(C&& callback) noexcept;
+
+    void wait_update() noexcept;
+
+    inline uint32_t grain() const noexcept;
+
+private:
+    template <typename C>
+    void run(C&& callback) noexcept;
+
+private:
+    std::vector<O*> _vectors;
+    std::vector<chunk> _chunks;
+    std::atomic<uint32_t> _next_chunk;
+    uint32_t _num_fibers;
+    uint32_t _min_grain;
+    uint32_t _grain;
+    uint32_t _pending_fibers;
+    boost::fibers::mutex _updates_mutex;
+    boost::fibers::condition_variable_any _updates_cv;
+};
+
+
+template <typename O>
+updater_chunked<O>::updater_chunked(uint32_t num_fibers, uint32_t min_grain) noexcept :
+    _vectors(),
+    _chunks(),
+    _next_chunk(0),
+    _num_fibers(std::max(num_fibers, 1u)),
+    _min_grain(std::max(min_grain, 1u)),
+    _grain(_min_grain),
+    _pending_fibers(0)
+{}
+
+template <typename O>
+updater_chunked<O>::updater_chunked(updater_chunked&& other) noexcept :
+    _vectors(std::move(other._vectors)),
+    _chunks(std::move(other._chunks)),
+    _next_chunk(0),
+    _num_fibers(other._num_fibers),
+    _min_grain(other._min_grain),
+    _grain(other._grain),
+    _pending_fibers(0)
+{
+    assert(other._pending_fibers == 0 && "Attempting to move an updater while updating");
+}
+
+template <typename O>
+updater_chunked<O>& updater_chunked<O>::operator=(updater_chunked&& other) noexcept
+{
+    assert(_pending_fibers == 0 && other._pending_fibers == 0 && "Attempting to move an updater while updating");
+
+    _vectors = std::move(other._vectors);
+    _chunks = std::move(other._chunks);
+    _num_fibers = other._num_fibers;
+    _min_grain = other._min_grain;
+    _grain = other._grain;
+    return *this;
+}
+
+template <typename O>
+inline void updater_chunked<O>::clear() noexcept
+{
+    _vectors.clear();
+}
+
+template <typename O>
+inline void updater_chunked<O>::push(O* vector) noexcept
+{
+    _vectors.push_back(vector);
+}
+
+template <typename O>
+template <typename... Args>
+void updater_chunked<O>::update(Args&&... args) noexcept
+{
+    if constexpr (!O::derived_t::template has_update<std::decay_t<Args>...>())
+    {
+        return;
+    }
+    else
+    {
+        run([...args{ std::forward<Args>(args) }](auto it, auto end) mutable {
+            for (; it != end; ++it)
+            {
+                (*it)->base()->base_update(args...);
+            }
+        });
+    }
+}
+
+template <typename O>
+template <typename C>
+void updater_chunked<O>::update_chunks(C&& callback) noexcept
+{
+    run(std::forward<C>(callback));
+}
+
+template <typename O>
+template <typename C>
+void updater_chunked<O>::run(C&& callback) noexcept
+{
+    // Aim for a few chunks per fiber, so that uneven chunks still balance out
+    uint32_t total = 0;
+    for (auto vector : _vectors)
+    {
+        total += vector->size();
+    }
+
+    _grain = std::max(_min_grain, (total + _num_fibers * 4 - 1) / (_num_fibers * 4));
+
+    _chunks.clear();
+    for (auto vector : _vectors)
+    {
+        uint32_t size = vector->size();
+        if (size == 0)
+        {
+            continue;
+        }
+
+        auto range = vector->range();
+        for (uint32_t begin = 0; begin < size; begin += _grain)
+        {
+            _chunks.push_back({ .range = range, .begin = begin, .end = std::min(size, begin + _grain) });
+        }
+    }
+
+    _next_chunk = 0;
+    _pending_fibers = std::min(_num_fibers, static_cast<uint32_t>(_chunks.size()));
+
+    for (uint32_t i = 0, n = _pending_fibers; i < n; ++i)
+    {
+        boost::fibers::fiber([this, callback]() mutable {
+            for (uint32_t idx = _next_chunk++; idx < _chunks.size(); idx = _next_chunk++)
+            {
+                auto& chunk = _chunks[idx];
+                callback(chunk.range.begin() + chunk.begin, chunk.range.begin() + chunk.end);
+            }
+
+            _updates_mutex.lock();
+            bool done = --_pending_fibers == 0;
+            _updates_mutex.unlock();
+
+            if (done)
+            {
+                _updates_cv.notify_all();
+            }
+        }).detach();
+    }
+}
+
+template <typename O>
+void updater_chunked<O>::wait_update() noexcept
+{
+    _updates_mutex.lock();
+    _updates_cv.wait(_updates_mutex, [this]() { return _pending_fibers == 0; });
+    _updates_mutex.unlock();
+
+#if !defined(NDEBUG)
+    for (auto vector : _vectors)
+    {
+        vector->unlock_writes();
+    }
+#endif
+}
+
+template <typename O>
+inline uint32_t updater_chunked<O>::grain() const noexcept
+{
+    return _grain;
+}
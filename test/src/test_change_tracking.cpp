@@ -0,0 +1,123 @@
+#include <catch2/catch_all.hpp>
+
+#include <entity/change_tracked.hpp>
+#include <entity/entity.hpp>
+#include <storage/growable_storage.hpp>
+#include <storage/partitioned_growable_storage.hpp>
+#include <storage/partitioned_static_storage.hpp>
+#include <storage/static_growable_storage.hpp>
+#include <storage/static_storage.hpp>
+
+
+class tracked_client : public entity<tracked_client>, public change_tracked
+{
+public:
+    using entity<tracked_client>::entity;
+
+    inline void construct(bool partition)
+    {
+        _partition = partition;
+    }
+
+    inline bool partition() const
+    {
+        return _partition;
+    }
+
+private:
+    bool _partition;
+};
+
+constexpr uint32_t tracked_size = 100;
+
+template <typename O>
+inline void push_tracked(O& orchestrator, uint64_t id)
+{
+    if constexpr (has_storage_tag(O::tag, storage_grow::none, storage_layout::partitioned))
+    {
+        orchestrator.push(id % 2 == 0, id, id % 2 == 0);
+    }
+    else
+    {
+        orchestrator.push(id, false);
+    }
+}
+
+template <typename O>
+inline int count_changed_since(O& orchestrator, change_epoch_t epoch)
+{
+    int count = 0;
+    for (auto obj : orchestrator.range_changed_since(epoch))
+    {
+        REQUIRE(obj->changed_since(epoch));
+        ++count;
+    }
+
+#if !defined(NDEBUG)
+    orchestrator.unlock_writes();
+#endif
+    return count;
+}
+
+template <template <typename, uint32_t> typename S>
+inline void generate_test_cases()
+{
+    orchestrator<S, tracked_client, tracked_size * 2> tracked;
+    orchestrator<S, tracked_client, tracked_size * 2> other;
+
+    change_epoch_t before_push = change_epoch::current();
+    for (int i = 0; i < tracked_size; ++i)
+    {
+        push_tracked(tracked, i);
+    }
+
+    GIVEN("A change tracked orchestrator " + std::string(typeid(tracked).name()))
+    {
+        THEN("All pushed objects are reported as changed")
+        {
+            REQUIRE(count_changed_since(tracked, before_push) == tracked_size);
+        }
+
+        WHEN("The epoch is advanced")
+        {
+            change_epoch_t epoch = change_epoch::advance();
+
+            THEN("No object is reported as changed")
+            {
+                REQUIRE(count_changed_since(tracked, epoch) == 0);
+            }
+
+            THEN("Only explicitly marked objects are reported")
+            {
+                tracked.get(3)->mark_changed();
+                tracked.get(7)->mark_changed();
+                REQUIRE(count_changed_since(tracked, epoch) == 2);
+            }
+
+            THEN("Marks survive swap-and-pop relocations")
+            {
+                tracked.get(tracked_size - 1)->mark_changed();
+                tracked.pop(tracked.get(0));
+                REQUIRE(tracked.get(tracked_size - 1)->changed_since(epoch));
+                REQUIRE(count_changed_since(tracked, epoch) == 1);
+            }
+
+            THEN("Moved objects are reported as changed in their new orchestrator")
+            {
+                tracked.move(other, tracked.get(5));
+
+                REQUIRE(count_changed_since(tracked, epoch) == 0);
+                REQUIRE(count_changed_since(other, epoch) == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Tests change tracking", "[orchestrator]")
+{
+    generate_test_cases<growable_storage>();
+    generate_test_cases<partitioned_growable_storage>();
+    generate_test_cases<partitioned_static_storage>();
+    generate_test_cases<static_growable_storage>();
+    generate_test_cases<static_storage>();
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch_all.hpp>
+
+#include <containers/command_buffer.hpp>
+#include <entity/entity.hpp>
+#include <entity/scheme.hpp>
+#include <storage/growable_storage.hpp>
+#include <storage/partitioned_growable_storage.hpp>
+
+#include <thread>
+#include <vector>
+
+
+class unit : public entity<unit>
+{
+public:
+    using entity<unit>::entity;
+};
+
+class unit_data : public entity<unit_data>
+{
+public:
+    using entity<unit_data>::entity;
+};
+
+constexpr uint32_t commands_size = 64;
+
+
+SCENARIO("command buffers are played back sorted", "[command_buffer]")
+{
+    GIVEN("a command buffer with commands recorded out of order")
+    {
+        command_buffer<int, 4> buffer;
+        buffer.create(5, 0);
+        buffer.destroy(2, 1);
+        buffer.move(9, 2);
+        buffer.move(1, 3);
+        buffer.change_partition(7, 4);
+        buffer.destroy(2, 5);
+
+        WHEN("it is played back")
+        {
+            std::vector<command<int>> played;
+            buffer.playback([&played](structural_command type, entity_id_t id, const int& payload) {
+                played.push_back({ .id = id, .type = type, .payload = payload });
+            });
+
+            THEN("commands are grouped by type, sorted by id and keep their recording order otherwise")
+            {
+                REQUIRE(played.size() == 6);
+                REQUIRE((played[0].type == structural_command::change_partition && played[0].id == 7));
+                REQUIRE((played[1].type == structural_command::move && played[1].id == 1));
+                REQUIRE((played[2].type == structural_command::move && played[2].id == 9));
+                REQUIRE((played[3].type == structural_command::destroy && played[3].payload == 1));
+                REQUIRE((played[4].type == structural_command::destroy && played[4].payload == 5));
+                REQUIRE((played[5].type == structural_command::create && played[5].id == 5));
+            }
+
+            THEN("the buffer is empty")
+            {
+                REQUIRE(buffer.empty());
+            }
+        }
+    }
+
+    GIVEN("a command buffer recorded from multiple threads")
+    {
+        command_buffer<int, 16> buffer;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&buffer, t]() {
+                for (int i = 0; i < commands_size; ++i)
+                {
+                    buffer.move(t * commands_size + i, t);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        THEN("all commands are played back exactly once")
+        {
+            entity_id_t expected = 0;
+            buffer.playback([&expected](structural_command type, entity_id_t id, const int& payload) {
+                REQUIRE(id == expected++);
+            });
+
+            REQUIRE(expected == 4 * commands_size);
+        }
+    }
+}
+
+SCENARIO("scheme commands apply structural changes", "[command_buffer]")
+{
+    GIVEN("two schemes with the same components")
+    {
+        scheme_store<growable_storage<unit, 128>, growable_storage<unit_data, 128>> store1;
+        scheme_store<growable_storage<unit, 128>, growable_storage<unit_data, 128>> store2;
+
+        auto scheme1 = scheme_maker<unit, unit_data>()(store1);
+        auto scheme2 = scheme_maker<unit, unit_data>()(store2);
+
+        using scheme_t = decltype(scheme1);
+
+        for (int i = 0; i < commands_size; ++i)
+        {
+            scheme1.create(i, scheme1.template args<unit>(), scheme1.template args<unit_data>());
+        }
+
+        command_buffer<scheme_command<scheme_t>, 4> buffer;
+
+        WHEN("moves and destroys are recorded and played back")
+        {
+            for (int i = 0; i < commands_size; i += 2)
+            {
+                buffer.move(i, { .from = &scheme1, .to = &scheme2 });
+            }
+
+            buffer.destroy(1, { .from = &scheme1 });
+
+            // Entity no longer in scheme1 by the time it is applied
+            buffer.destroy(2, { .from = &scheme1 });
+
+            // Does not exist at all
+            buffer.destroy(commands_size * 2, { .from = &scheme1 });
+
+            buffer.playback([](structural_command type, entity_id_t id, const scheme_command<scheme_t>& payload) {
+                apply_scheme_command(type, id, payload);
+            });
+
+            THEN("entities are found where expected")
+            {
+                REQUIRE(scheme1.size() == commands_size / 2 - 1);
+                REQUIRE(scheme2.size() == commands_size / 2);
+                REQUIRE(scheme2.template get<unit>(2) != nullptr);
+                REQUIRE(scheme2.template get<unit_data>(2) != nullptr);
+                REQUIRE(scheme1.template get<unit>(1) == nullptr);
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_all.hpp>
+
+#include <containers/completion_queue.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+
+struct query_result
+{
+    int code;
+    std::string payload;
+};
+
+SCENARIO("completion queues deliver results to valid tickets only", "[completion_queue]")
+{
+    GIVEN("a queue with results for valid and invalid tickets")
+    {
+        int first = 1;
+        int second = 2;
+        ticket<int>::ptr first_ticket(new ticket<int>(&first));
+        ticket<int>::ptr second_ticket(new ticket<int>(&second));
+        ticket<int>::ptr gone_ticket(new ticket<int>(nullptr));
+
+        completion_queue<int, query_result> queue;
+        queue.push(first_ticket, 0, "first");
+        queue.push(gone_ticket, 0, "gone");
+        queue.push(second_ticket, 1, "second");
+
+        WHEN("it is drained")
+        {
+            std::vector<std::pair<int, std::string>> delivered;
+            auto count = queue.drain([&delivered](int* target, query_result& result) {
+                delivered.emplace_back(*target, std::move(result.payload));
+            });
+
+            THEN("results are dispatched in order, skipping invalid tickets")
+            {
+                REQUIRE(count == 2);
+                REQUIRE(delivered.size() == 2);
+                REQUIRE(delivered[0] == std::pair<int, std::string>(1, "first"));
+                REQUIRE(delivered[1] == std::pair<int, std::string>(2, "second"));
+            }
+
+            THEN("the next drain is empty")
+            {
+                REQUIRE(queue.drain([](int*, query_result&) {}) == 0);
+            }
+        }
+    }
+
+    GIVEN("several producer threads")
+    {
+        int target = 0;
+        ticket<int>::ptr target_ticket(new ticket<int>(&target));
+        completion_queue<int, query_result> queue;
+
+        WHEN("they push while the queue is being drained")
+        {
+            constexpr int num_threads = 4;
+            constexpr int results_per_thread = 1000;
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t)
+            {
+                threads.emplace_back([&queue, &target_ticket, t]() {
+                    for (int i = 0; i < results_per_thread; ++i)
+                    {
+                        queue.push(target_ticket, t, "");
+                    }
+                });
+            }
+
+            std::size_t total = 0;
+            auto drain = [&queue, &total]() {
+                total += queue.drain([](int*, query_result&) {});
+            };
+
+            for (int i = 0; i < 100; ++i)
+            {
+                drain();
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            drain();
+
+            THEN("every result is delivered exactly once")
+            {
+                REQUIRE(total == num_threads * results_per_thread);
+            }
+        }
+    }
+}
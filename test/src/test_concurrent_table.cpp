@@ -0,0 +1,122 @@
+#include <catch2/catch_all.hpp>
+
+#include <containers/concurrent_table.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+SCENARIO("concurrent tables behave as maps for a single thread", "[concurrent_table]")
+{
+    GIVEN("a small table")
+    {
+        concurrent_table<uint32_t, uint32_t, 8> table(4);
+
+        WHEN("more keys than its capacity are inserted")
+        {
+            for (uint32_t i = 0; i < 100; ++i)
+            {
+                REQUIRE(table.insert(i, i * 2));
+            }
+
+            THEN("it grows and all keys are found")
+            {
+                REQUIRE(table.size() == 100);
+                REQUIRE(table.capacity() >= 128);
+
+                for (uint32_t i = 0; i < 100; ++i)
+                {
+                    REQUIRE(table.find(i) == i * 2);
+                }
+
+                REQUIRE(!table.contains(100));
+            }
+
+            THEN("keys can not be inserted twice")
+            {
+                REQUIRE(!table.insert(5, 0));
+                REQUIRE(table.find(5) == 10);
+            }
+        }
+
+        WHEN("keys are erased and inserted again")
+        {
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                table.insert(i, i);
+            }
+
+            REQUIRE(table.erase(1));
+            REQUIRE(!table.erase(1));
+            REQUIRE(table.insert(1, 10));
+
+            THEN("the newest value is found")
+            {
+                REQUIRE(table.size() == 3);
+                REQUIRE(table.find(1) == 10);
+            }
+        }
+    }
+}
+
+SCENARIO("concurrent tables can be read while being written", "[concurrent_table]")
+{
+    GIVEN("a table being filled and emptied by a writer")
+    {
+        concurrent_table<uint32_t, uint32_t, 8> table(4);
+        std::atomic<bool> done = false;
+        std::atomic<uint32_t> mismatches = 0;
+
+        // Even keys are never erased
+        for (uint32_t i = 0; i < 64; i += 2)
+        {
+            table.insert(i, i);
+        }
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r)
+        {
+            readers.push_back(std::thread([&table, &done, &mismatches] {
+                while (!done)
+                {
+                    for (uint32_t i = 0; i < 64; ++i)
+                    {
+                        auto value = table.find(i);
+                        if ((i % 2 == 0 && value != i) || (value && *value != i))
+                        {
+                            ++mismatches;
+                        }
+                    }
+                }
+            }));
+        }
+
+        for (int round = 0; round < 1000; ++round)
+        {
+            for (uint32_t i = 1; i < 64; i += 2)
+            {
+                table.insert(i, i);
+            }
+
+            for (uint32_t i = 1; i < 64; i += 2)
+            {
+                table.erase(i);
+            }
+
+            table.reclaim();
+        }
+
+        done = true;
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+
+        THEN("readers always see consistent values")
+        {
+            REQUIRE(mismatches == 0);
+            REQUIRE(table.size() == 32);
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#include <catch2/catch_all.hpp>
+
+#include <pools/frame_allocator.hpp>
+
+#include <cstdint>
+#include <future>
+#include <thread>
+
+
+namespace
+{
+    inline uintptr_t address_of(const void* pointer)
+    {
+        return reinterpret_cast<uintptr_t>(pointer);
+    }
+
+    struct alignas(32) wide
+    {
+        float values[8];
+    };
+}
+
+
+SCENARIO("frame arenas hand out bump allocated memory until reset", "[frame_allocator]")
+{
+    GIVEN("the calling thread's arena at the start of a frame")
+    {
+        frame_arena::reset_all();
+        frame_arena& arena = frame_arena::this_thread();
+        REQUIRE(arena.used() == 0);
+
+        WHEN("allocating with different alignments")
+        {
+            void* byte = arena.allocate(1, 1);
+            void* cache_line = arena.allocate(16, 64);
+            void* page = arena.allocate(8, 4096);
+
+            THEN("every pointer is aligned as requested and they do not overlap")
+            {
+                REQUIRE(address_of(cache_line) % 64 == 0);
+                REQUIRE(address_of(page) % 4096 == 0);
+                REQUIRE(address_of(cache_line) > address_of(byte));
+                REQUIRE(address_of(page) >= address_of(cache_line) + 16);
+                REQUIRE(arena.used() == 1 + 16 + 8);
+            }
+        }
+
+        WHEN("the frame is reset")
+        {
+            void* first = arena.allocate(128, 16);
+            arena.allocate(256, 16);
+            frame_arena::reset_all();
+
+            THEN("usage is cleared and memory is handed out again from the start")
+            {
+                REQUIRE(arena.used() == 0);
+                REQUIRE(arena.allocate(128, 16) == first);
+            }
+        }
+
+        WHEN("a frame does not fit in a single block")
+        {
+            // Fresh threads start with a single block, regardless of what this one used before
+            constexpr std::size_t size = frame_arena::block_size / 2 + 8;
+            bool contiguous_before = true;
+            bool contiguous_after = false;
+            std::size_t used = 0;
+
+            std::thread([&]() {
+                frame_arena& arena = frame_arena::this_thread();
+                auto first = static_cast<uint8_t*>(arena.allocate(size, 8));
+                auto second = static_cast<uint8_t*>(arena.allocate(size, 8));
+                auto third = static_cast<uint8_t*>(arena.allocate(size, 8));
+                contiguous_before = second == first + size || third == second + size;
+                used = arena.used();
+
+                arena.reset();
+                first = static_cast<uint8_t*>(arena.allocate(size, 8));
+                second = static_cast<uint8_t*>(arena.allocate(size, 8));
+                third = static_cast<uint8_t*>(arena.allocate(size, 8));
+                contiguous_after = second == first + size && third == second + size;
+            }).join();
+
+            THEN("overflowing allocations come from new blocks")
+            {
+                REQUIRE(!contiguous_before);
+                REQUIRE(used == 3 * size);
+            }
+
+            THEN("blocks are merged on reset and the same frame becomes contiguous")
+            {
+                REQUIRE(contiguous_after);
+            }
+        }
+    }
+
+    GIVEN("another thread using its own arena")
+    {
+        frame_arena::reset_all();
+
+        WHEN("all arenas are reset from the main thread")
+        {
+            std::promise<std::size_t> allocated;
+            std::promise<void> reset;
+            std::promise<std::size_t> after_reset;
+
+            std::thread worker([&]() {
+                frame_arena& arena = frame_arena::this_thread();
+                arena.allocate(512, 8);
+                allocated.set_value(arena.used());
+
+                reset.get_future().wait();
+                after_reset.set_value(arena.used());
+            });
+
+            const std::size_t used = allocated.get_future().get();
+            frame_arena::this_thread().allocate(64, 8);
+
+            frame_arena::reset_all();
+            reset.set_value();
+            const std::size_t used_after_reset = after_reset.get_future().get();
+            worker.join();
+
+            THEN("every thread's arena is reset")
+            {
+                REQUIRE(used == 512);
+                REQUIRE(used_after_reset == 0);
+                REQUIRE(frame_arena::this_thread().used() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("frame vectors allocate from the calling thread's arena", "[frame_allocator]")
+{
+    GIVEN("an empty arena")
+    {
+        frame_arena::reset_all();
+        frame_arena& arena = frame_arena::this_thread();
+
+        WHEN("vectors of over-aligned types grow")
+        {
+            frame_vector<wide> wides;
+            frame_vector<double> doubles;
+            for (int i = 0; i < 100; ++i)
+            {
+                wides.push_back(wide{});
+                doubles.push_back(static_cast<double>(i));
+            }
+
+            THEN("their storage is aligned and comes from the arena")
+            {
+                REQUIRE(address_of(wides.data()) % alignof(wide) == 0);
+                REQUIRE(address_of(doubles.data()) % alignof(double) == 0);
+                REQUIRE(arena.used() >= 100 * (sizeof(wide) + sizeof(double)));
+                REQUIRE(doubles[99] == 99.0);
+            }
+        }
+
+        WHEN("allocators of different types are compared")
+        {
+            THEN("they are interchangeable")
+            {
+                REQUIRE(frame_allocator<int>() == frame_allocator<double>());
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include <catch2/catch_all.hpp>
+
+#include <ids/generator.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+SCENARIO("block generators hand out unique ids from per thread ranges", "[generator]")
+{
+    GIVEN("a generator with small blocks")
+    {
+        block_generator<8, 16> generator;
+
+        WHEN("a single thread requests ids")
+        {
+            std::vector<uint64_t> ids;
+            for (int i = 0; i < 40; ++i)
+            {
+                ids.push_back(generator.next());
+            }
+
+            THEN("they are consecutive and whole blocks are reserved")
+            {
+                for (int i = 1; i < 40; ++i)
+                {
+                    REQUIRE(ids[i] == ids[i - 1] + 1);
+                }
+
+                REQUIRE(generator.peek() == ids.front() + 48);
+            }
+        }
+
+        WHEN("several threads request ids concurrently")
+        {
+            constexpr int num_threads = 4;
+            constexpr int ids_per_thread = 10000;
+
+            std::vector<std::vector<uint64_t>> ids(num_threads);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t)
+            {
+                threads.emplace_back([&generator, &ids, t]() {
+                    for (int i = 0; i < ids_per_thread; ++i)
+                    {
+                        ids[t].push_back(generator.next());
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            THEN("there are no collisions and each thread sees increasing ids")
+            {
+                std::unordered_set<uint64_t> unique;
+                for (const auto& list : ids)
+                {
+                    REQUIRE(std::is_sorted(list.begin(), list.end()));
+                    unique.insert(list.begin(), list.end());
+                }
+
+                REQUIRE(unique.size() == num_threads * ids_per_thread);
+            }
+        }
+    }
+
+    GIVEN("a generator whose blocks are exhausted many times by every thread")
+    {
+        constexpr uint32_t block_size = 8;
+        block_generator<4, block_size> generator;
+
+        WHEN("more threads than slots draw several blocks each at the same time")
+        {
+            constexpr int num_threads = 8;
+            constexpr int ids_per_thread = block_size * 50;
+
+            std::atomic<bool> start = false;
+            std::vector<std::vector<uint64_t>> ids(num_threads);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t)
+            {
+                threads.emplace_back([&generator, &ids, &start, t]() {
+                    while (!start)
+                    {
+                        std::this_thread::yield();
+                    }
+
+                    for (int i = 0; i < ids_per_thread; ++i)
+                    {
+                        ids[t].push_back(generator.next());
+                    }
+                });
+            }
+
+            start = true;
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            THEN("ids are unique across all threads and blocks, and below the reserved bound")
+            {
+                std::unordered_set<uint64_t> unique;
+                for (const auto& list : ids)
+                {
+                    REQUIRE(std::is_sorted(list.begin(), list.end()));
+                    for (auto id : list)
+                    {
+                        REQUIRE(id < generator.peek());
+                    }
+
+                    unique.insert(list.begin(), list.end());
+                }
+
+                REQUIRE(unique.size() == num_threads * ids_per_thread);
+            }
+        }
+    }
+
+    GIVEN("a generator with fewer slots than threads")
+    {
+        block_generator<1, 16> generator;
+
+        WHEN("more threads than slots request ids")
+        {
+            constexpr int num_threads = 4;
+            constexpr int ids_per_thread = 1000;
+
+            std::vector<std::vector<uint64_t>> ids(num_threads);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t)
+            {
+                threads.emplace_back([&generator, &ids, t]() {
+                    for (int i = 0; i < ids_per_thread; ++i)
+                    {
+                        ids[t].push_back(generator.next());
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            THEN("the extra threads still get unique ids")
+            {
+                std::unordered_set<uint64_t> unique;
+                for (const auto& list : ids)
+                {
+                    unique.insert(list.begin(), list.end());
+                }
+
+                REQUIRE(unique.size() == num_threads * ids_per_thread);
+            }
+        }
+    }
+}
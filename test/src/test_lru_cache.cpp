@@ -0,0 +1,83 @@
+#include <catch2/catch_all.hpp>
+
+#include <containers/lru_cache.hpp>
+
+#include <string>
+
+
+SCENARIO("lru caches evict the least recently used entries", "[lru_cache]")
+{
+    GIVEN("a cache with room for 10 units")
+    {
+        lru_cache<int, std::string> cache(10);
+        cache.put(1, "one", 3);
+        cache.put(2, "two", 3);
+        cache.put(3, "three", 3);
+
+        THEN("all entries are found and accounted")
+        {
+            REQUIRE(cache.size() == 3);
+            REQUIRE(cache.used() == 9);
+            REQUIRE(*cache.get(2) == "two");
+        }
+
+        WHEN("an entry that does not fit is inserted")
+        {
+            cache.put(4, "four", 3);
+
+            THEN("the oldest one is evicted")
+            {
+                REQUIRE(cache.get(1) == nullptr);
+                REQUIRE(cache.get(4) != nullptr);
+                REQUIRE(cache.used() == 9);
+            }
+        }
+
+        WHEN("the oldest entry is read before inserting")
+        {
+            REQUIRE(cache.get(1) != nullptr);
+            cache.put(4, "four", 3);
+
+            THEN("the next oldest one is evicted instead")
+            {
+                REQUIRE(cache.get(1) != nullptr);
+                REQUIRE(cache.get(2) == nullptr);
+            }
+        }
+
+        WHEN("an entry is replaced with a bigger one")
+        {
+            cache.put(2, "TWO", 7);
+
+            THEN("only as many entries as needed are evicted")
+            {
+                REQUIRE(*cache.get(2) == "TWO");
+                REQUIRE(cache.get(1) == nullptr);
+                REQUIRE(cache.get(3) != nullptr);
+                REQUIRE(cache.used() == 10);
+            }
+        }
+
+        WHEN("an entry bigger than the whole cache is inserted")
+        {
+            cache.put(5, "five", 11);
+
+            THEN("it is not stored and nothing is evicted")
+            {
+                REQUIRE(cache.get(5) == nullptr);
+                REQUIRE(cache.size() == 3);
+            }
+        }
+
+        WHEN("entries are erased")
+        {
+            REQUIRE(cache.erase(1));
+            REQUIRE(!cache.erase(1));
+
+            THEN("their size is released")
+            {
+                REQUIRE(cache.used() == 6);
+            }
+        }
+    }
+}
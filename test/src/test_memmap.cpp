@@ -0,0 +1,91 @@
+#include <catch2/catch_all.hpp>
+
+#include <io/memmap.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+
+SCENARIO("files can be mapped for reading and writing", "[memmap]")
+{
+    const auto path = (std::filesystem::temp_directory_path() / "umi_test_memmap.bin").string();
+    std::filesystem::remove(path);
+
+    GIVEN("a file mapped for writing with an initial size")
+    {
+        auto mapping = map_file(path.c_str(), map_access::read_write, 4096);
+        REQUIRE(mapping);
+        REQUIRE(mapping->length == 4096);
+        REQUIRE(std::filesystem::file_size(path) == 4096);
+
+        std::memcpy(mapping->addr, "umi", 3);
+
+        WHEN("it is grown and written past the previous end")
+        {
+            REQUIRE(resize_mapping(*mapping, 3 * 4096));
+            std::memcpy(mapping->addr + 2 * 4096, "end", 3);
+            REQUIRE(flush_mapping(*mapping, 2 * 4096 + 1, 2));
+            unmap_file(*mapping);
+
+            THEN("a read only mapping sees both writes")
+            {
+                auto reader = map_file(path.c_str());
+                REQUIRE(reader);
+                REQUIRE(reader->length == 3 * 4096);
+                REQUIRE(std::memcmp(reader->addr, "umi", 3) == 0);
+                REQUIRE(std::memcmp(reader->addr + 2 * 4096, "end", 3) == 0);
+
+                REQUIRE(advise_mapping(*reader, map_advice::sequential));
+                REQUIRE(advise_mapping(*reader, map_advice::will_need, 4096, 10));
+                REQUIRE(!flush_mapping(*reader));
+                unmap_file(*reader);
+            }
+        }
+
+        WHEN("it is shrunk")
+        {
+            REQUIRE(resize_mapping(*mapping, 16));
+            unmap_file(*mapping);
+
+            THEN("the file is truncated and keeps its contents")
+            {
+                REQUIRE(std::filesystem::file_size(path) == 16);
+
+                auto reader = map_file(path.c_str());
+                REQUIRE(reader);
+                REQUIRE(std::memcmp(reader->addr, "umi", 3) == 0);
+                unmap_file(*reader);
+            }
+        }
+    }
+
+    GIVEN("an empty file")
+    {
+        auto mapping = map_file(path.c_str(), map_access::read_write);
+        REQUIRE(mapping);
+
+        THEN("it is mapped without an address and can be grown")
+        {
+            REQUIRE(mapping->length == 0);
+            REQUIRE(mapping->addr == nullptr);
+
+            REQUIRE(resize_mapping(*mapping, 100));
+            REQUIRE(mapping->addr != nullptr);
+            mapping->addr[99] = 'x';
+            REQUIRE(flush_mapping(*mapping));
+        }
+
+        unmap_file(*mapping);
+    }
+
+    GIVEN("a file that does not exist")
+    {
+        THEN("it can't be mapped for reading")
+        {
+            REQUIRE(!map_file(path.c_str()));
+        }
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,118 @@
+#include <catch2/catch_all.hpp>
+
+#include <containers/ring_log.hpp>
+
+#include <memory>
+#include <vector>
+
+
+SCENARIO("ring logs keep entries addressable until truncated", "[ring_log]")
+{
+    GIVEN("a log with entries spanning several blocks")
+    {
+        ring_log<int, 4> log;
+        std::vector<int*> pointers;
+        for (int i = 0; i < 10; ++i)
+        {
+            REQUIRE(log.emplace(i) == static_cast<uint64_t>(i));
+            pointers.push_back(log.get(i));
+        }
+
+        THEN("every entry is found by its sequence number")
+        {
+            REQUIRE(log.size() == 10);
+            for (int i = 0; i < 10; ++i)
+            {
+                REQUIRE(*log.get(i) == i);
+            }
+
+            REQUIRE(log.get(10) == nullptr);
+        }
+
+        WHEN("more entries are appended")
+        {
+            for (int i = 10; i < 100; ++i)
+            {
+                log.emplace(i);
+            }
+
+            THEN("earlier entries have not moved")
+            {
+                for (int i = 0; i < 10; ++i)
+                {
+                    REQUIRE(log.get(i) == pointers[i]);
+                }
+            }
+        }
+
+        WHEN("a prefix is truncated")
+        {
+            log.truncate_while([](int value) { return value < 6; });
+
+            THEN("truncated entries are gone and the rest are untouched")
+            {
+                REQUIRE(log.first() == 6);
+                REQUIRE(log.end() == 10);
+                REQUIRE(log.get(5) == nullptr);
+                REQUIRE(log.get(6) == pointers[6]);
+                REQUIRE(*log.get(9) == 9);
+            }
+
+            THEN("sequence numbers keep increasing")
+            {
+                REQUIRE(log.emplace(10) == 10);
+                REQUIRE(*log.get(10) == 10);
+            }
+        }
+
+        WHEN("everything is truncated and the log is reused")
+        {
+            log.truncate_while([](int) { return true; });
+            REQUIRE(log.empty());
+
+            for (int i = 10; i < 20; ++i)
+            {
+                log.emplace(i);
+            }
+
+            THEN("new entries continue from the last sequence number")
+            {
+                REQUIRE(log.first() == 10);
+                for (int i = 10; i < 20; ++i)
+                {
+                    REQUIRE(*log.get(i) == i);
+                }
+            }
+        }
+    }
+
+    GIVEN("a log of owning entries")
+    {
+        auto tracker = std::make_shared<int>(0);
+
+        {
+            ring_log<std::shared_ptr<int>, 4> log;
+            for (int i = 0; i < 7; ++i)
+            {
+                log.emplace(tracker);
+            }
+
+            log.truncate_while([](const std::shared_ptr<int>&) { return true; });
+            REQUIRE(tracker.use_count() == 1);
+
+            for (int i = 0; i < 5; ++i)
+            {
+                log.emplace(tracker);
+            }
+
+            ring_log<std::shared_ptr<int>, 4> moved(std::move(log));
+            REQUIRE(tracker.use_count() == 6);
+            REQUIRE(log.empty());
+        }
+
+        THEN("entries are destroyed when truncated or when the log is")
+        {
+            REQUIRE(tracker.use_count() == 1);
+        }
+    }
+}
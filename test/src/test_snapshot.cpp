@@ -0,0 +1,142 @@
+#include <catch2/catch_all.hpp>
+
+#include <entity/entity.hpp>
+#include <entity/scheme.hpp>
+#include <io/snapshot.hpp>
+#include <storage/growable_storage.hpp>
+#include <storage/partitioned_growable_storage.hpp>
+
+#include <filesystem>
+#include <string>
+
+
+class position : public entity<position>
+{
+public:
+    using entity<position>::entity;
+
+    static constexpr bool trivially_relocatable = true;
+
+    void construct(float x, float y)
+    {
+        this->x = x;
+        this->y = y;
+    }
+
+    float x;
+    float y;
+};
+
+class nameplate : public entity<nameplate>
+{
+public:
+    using entity<nameplate>::entity;
+
+    void construct(std::string name)
+    {
+        this->name = std::move(name);
+    }
+
+    void serialize(snapshot_writer& writer) const
+    {
+        writer.write(static_cast<uint32_t>(name.size()));
+        writer.write(name.data(), name.size());
+    }
+
+    bool deserialize(snapshot_reader& reader)
+    {
+        uint32_t size;
+        if (!reader.read(size))
+        {
+            return false;
+        }
+
+        if (const char* bytes = reader.take(size))
+        {
+            name.assign(bytes, size);
+            return true;
+        }
+
+        return false;
+    }
+
+    std::string name;
+};
+
+class session : public entity<session>
+{
+public:
+    using entity<session>::entity;
+};
+
+
+SCENARIO("scheme stores can be snapshotted and restored", "[snapshot]")
+{
+    using store_t = scheme_store<partitioned_growable_storage<position, 128>, growable_storage<nameplate, 128>, growable_storage<session, 128>>;
+    const auto path = (std::filesystem::temp_directory_path() / "umi_test_snapshot.bin").string();
+
+    GIVEN("a store with entities of several schemes")
+    {
+        store_t store;
+        auto named = scheme_maker<position, nameplate>()(store);
+        auto anonymous = scheme_maker<position>()(store);
+        auto sessions = scheme_maker<session>()(store);
+
+        named.create(1, named.args<position>(true, 1.0f, 2.0f), named.args<nameplate>(std::string("first")));
+        named.create(2, named.args<position>(false, 3.0f, 4.0f), named.args<nameplate>(std::string("second")));
+        anonymous.create(3, anonymous.args<position>(false, 5.0f, 6.0f));
+        sessions.create(4, sessions.args<session>());
+
+        REQUIRE(snapshot::save(store, path.c_str()));
+
+        WHEN("it is restored into an empty store")
+        {
+            store_t restored;
+            auto restored_named = scheme_maker<position, nameplate>()(restored);
+            auto restored_anonymous = scheme_maker<position>()(restored);
+
+            REQUIRE(snapshot::load(path.c_str(), restored, restored_named, restored_anonymous));
+
+            THEN("snapshotable components are restored, with their partitions")
+            {
+                REQUIRE(restored.get<position>().size() == 3);
+                REQUIRE(restored.get<nameplate>().size() == 2);
+                REQUIRE(restored.get<position>().size_until_partition() == 1);
+
+                auto first = restored.get<position>().get(1);
+                REQUIRE(first != nullptr);
+                REQUIRE(first->x == 1.0f);
+                REQUIRE(first->y == 2.0f);
+                REQUIRE(first->ticket()->valid());
+
+                REQUIRE(restored.get<nameplate>().get(2)->name == "second");
+            }
+
+            THEN("components without snapshot support are left out")
+            {
+                REQUIRE(restored.get<session>().size() == 0);
+            }
+
+            THEN("entities are linked to their own scheme")
+            {
+                auto first = restored.get<position>().get(1);
+                REQUIRE(first->get<nameplate>() == restored.get<nameplate>().get(1));
+
+                auto third = restored.get<position>().get(3);
+                REQUIRE(third->components() != nullptr);
+                REQUIRE(third->get<nameplate>() == nullptr);
+            }
+        }
+
+        WHEN("the file is truncated")
+        {
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+            store_t restored;
+            THEN("restoring fails")
+            {
+                REQUIRE(!snapshot::load(path.c_str(), restored));
+            }
+        }
+    }
+}